@@ -0,0 +1,715 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "math/traits.h"
+#include "math/basic.h"
+#include "math/power.h"
+#include "math/exp.h"
+#include "math/log.h"
+#include "math/sqrt.h"
+#include "math/erf.h"
+#include "math/trig.h"
+#include "math/norm.h"
+#include "math/norm_table.h"
+#include "math/sobol.h"
+#include "math/integral.h"
+#include "math/simd.h"
+#include "math/aad.h"
+#include "math/dual.h"
+
+#include "model/black_scholes.h"
+#include "model/black_scholes_batch.h"
+#include "model/coupon_bond.h"
+#include "model/coupon_bond_batch.h"
+#include "model/yield_curve.h"
+#include "engine/portfolio.h"
+#include "engine/revaluation.h"
+#include "model/monte_carlo.h"
+#include "model/cos_method.h"
+#include "model/finite_difference.h"
+#include "model/lattice.h"
+
+/*
+ * Every kernel is measured over batches of 1, 64 and 4096 arguments, reporting items per second.
+ * Kernels with a standard library counterpart also report max_rel_err, their largest relative deviation from it,
+ * so that speed and accuracy of a kernel can be tracked together across commits:
+ *
+ *    cqf_bench --benchmark_out=bench.json --benchmark_out_format=json
+ *
+ * cqf_*   public functions as called at runtime
+ * impl_*  recursive implementations evaluated at runtime, i.e. what constant expressions compute
+ * std_*   standard library baseline
+ * table_* interpolated compile-time tables
+ * simd_*  array kernels of math/simd.h, second argument selecting SSE2 (0), AVX2 (1) or AVX-512 (2)
+ */
+
+namespace {
+std::vector<double> linspace(double lo, double hi, size_t n) {
+  std::vector<double> x(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = n == 1 ? (lo + hi) / 2 : lo + (hi - lo) * static_cast<double>(i) / static_cast<double>(n - 1);
+  }
+  return x;
+}
+
+template<typename Func, typename Reference>
+double max_rel_err(Func func, Reference reference, double lo, double hi) {
+  double err = 0.;
+  for (double x : linspace(lo, hi, 10007)) {
+    const double expected = reference(x);
+    const double scale = std::abs(expected) > cqf::limits<double>::min() ? std::abs(expected) : 1.;
+    err = std::max(err, std::abs(func(x) - expected) / scale);
+  }
+  return err;
+}
+
+template<typename Func, typename Reference>
+void unary(benchmark::State &state, Func func, Reference reference, double lo, double hi) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  const std::vector<double> x = linspace(lo, hi, n);
+  std::vector<double> y(n);
+  for (auto _ : state) {
+    for (size_t i = 0; i < n; ++i) {
+      y[i] = func(x[i]);
+    }
+    benchmark::DoNotOptimize(y.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+  state.counters["max_rel_err"] = max_rel_err(func, reference, lo, hi);
+}
+
+template<typename Kernel, typename Reference>
+void vectorized(benchmark::State &state, Kernel kernel, Reference reference, double lo, double hi) {
+  const auto set = static_cast<cqf::simd::isa>(state.range(1));
+  if (!cqf::simd::supported(set)) {
+    state.SkipWithError("instruction set not supported");
+    return;
+  }
+  cqf::simd::select(set);
+  const size_t n = static_cast<size_t>(state.range(0));
+  const std::vector<double> x = linspace(lo, hi, n);
+  std::vector<double> y(n);
+  for (auto _ : state) {
+    kernel(x.data(), y.data(), n);
+    benchmark::DoNotOptimize(y.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+
+  const std::vector<double> grid = linspace(lo, hi, 10007);
+  std::vector<double> values(grid.size());
+  kernel(grid.data(), values.data(), grid.size());
+  double err = 0.;
+  for (size_t i = 0; i < grid.size(); ++i) {
+    const double expected = reference(grid[i]);
+    const double scale = std::abs(expected) > cqf::limits<double>::min() ? std::abs(expected) : 1.;
+    err = std::max(err, std::abs(values[i] - expected) / scale);
+  }
+  state.counters["max_rel_err"] = err;
+}
+
+void batch_sizes(benchmark::internal::Benchmark *b) {
+  b->Arg(1)->Arg(64)->Arg(4096);
+}
+
+void simd_sizes(benchmark::internal::Benchmark *b) {
+  for (int set = 0; set < 3; ++set) {
+    for (int n : {64, 4096}) {
+      b->Args({n, set});
+    }
+  }
+}
+} // namespace
+
+#define CQF_BENCH_UNARY(name, expression, reference, lo, hi, sizes)                     \
+  void BM_##name(benchmark::State &state) {                                              \
+    unary(state, [](double x) { return expression; }, [](double x) { return reference; }, lo, hi); \
+  }                                                                                      \
+  BENCHMARK(BM_##name)->Apply(sizes)
+
+#define CQF_BENCH_SIMD(name, kernel, reference, lo, hi)                                   \
+  void BM_##name(benchmark::State &state) {                                              \
+    vectorized(state, [](const double *x, double *y, size_t n) { kernel(x, y, n); },   \
+               [](double x) { return reference; }, lo, hi);                              \
+  }                                                                                      \
+  BENCHMARK(BM_##name)->Apply(simd_sizes)
+
+void recursive_sizes(benchmark::internal::Benchmark *b) {
+  b->Arg(64);
+}
+
+// exponential
+CQF_BENCH_UNARY(cqf_exp, cqf::exp(x), std::exp(x), -20., 20., batch_sizes);
+CQF_BENCH_UNARY(impl_exp, cqf::impl::exp_impl(x), std::exp(x), -20., 20., recursive_sizes);
+CQF_BENCH_UNARY(std_exp, std::exp(x), std::exp(x), -20., 20., batch_sizes);
+CQF_BENCH_SIMD(simd_exp, cqf::simd::exp, std::exp(x), -20., 20.);
+
+// natural logarithm
+CQF_BENCH_UNARY(cqf_ln, cqf::ln(x), std::log(x), 1e-3, 1e3, batch_sizes);
+CQF_BENCH_UNARY(impl_ln, cqf::impl::ln_impl(x), std::log(x), 1e-3, 1e3, recursive_sizes);
+CQF_BENCH_UNARY(std_ln, std::log(x), std::log(x), 1e-3, 1e3, batch_sizes);
+CQF_BENCH_SIMD(simd_ln, cqf::simd::ln, std::log(x), 1e-3, 1e3);
+
+// square root
+CQF_BENCH_UNARY(cqf_sqrt, cqf::sqrt(x), std::sqrt(x), 0., 1e3, batch_sizes);
+CQF_BENCH_UNARY(impl_sqrt, cqf::impl::sqrt_impl(x), std::sqrt(x), 0., 1e3, recursive_sizes);
+CQF_BENCH_UNARY(std_sqrt, std::sqrt(x), std::sqrt(x), 0., 1e3, batch_sizes);
+CQF_BENCH_SIMD(simd_sqrt, cqf::simd::sqrt, std::sqrt(x), 0., 1e3);
+
+// error function
+CQF_BENCH_UNARY(cqf_erf, cqf::erf(x), std::erf(x), -6., 6., batch_sizes);
+CQF_BENCH_UNARY(impl_erf, cqf::impl::erf_impl(x), std::erf(x), -6., 6., recursive_sizes);
+CQF_BENCH_UNARY(std_erf, std::erf(x), std::erf(x), -6., 6., batch_sizes);
+CQF_BENCH_SIMD(simd_erf, cqf::simd::erf, std::erf(x), -6., 6.);
+CQF_BENCH_SIMD(simd_erfc, cqf::simd::erfc, std::erfc(x), -6., 6.);
+
+// normal distribution
+CQF_BENCH_UNARY(cqf_norm_cdf, cqf::norm_cdf(x), 0.5 * std::erfc(-x / std::sqrt(2.)), -8., 8., batch_sizes);
+CQF_BENCH_UNARY(std_norm_cdf, 0.5 * std::erfc(-x / std::sqrt(2.)), 0.5 * std::erfc(-x / std::sqrt(2.)),
+                -8., 8., batch_sizes);
+CQF_BENCH_UNARY(table_norm_cdf, cqf::norm_cdf_table(x), 0.5 * std::erfc(-x / std::sqrt(2.)), -8., 8., batch_sizes);
+CQF_BENCH_UNARY(cqf_norm_pdf, cqf::norm_pdf(x), std::exp(-0.5 * x * x) / std::sqrt(2 * M_PI), -8., 8., batch_sizes);
+CQF_BENCH_UNARY(table_norm_pdf, cqf::norm_pdf_table(x), std::exp(-0.5 * x * x) / std::sqrt(2 * M_PI),
+                -8., 8., batch_sizes);
+
+// trigonometry
+CQF_BENCH_UNARY(cqf_sin, cqf::sin(x), std::sin(x), -10., 10., batch_sizes);
+CQF_BENCH_UNARY(impl_sin, cqf::impl::sin_impl(cqf::wrap_angle(x)), std::sin(x), -10., 10., recursive_sizes);
+CQF_BENCH_UNARY(std_sin, std::sin(x), std::sin(x), -10., 10., batch_sizes);
+CQF_BENCH_UNARY(cqf_cos, cqf::cos(x), std::cos(x), -10., 10., batch_sizes);
+CQF_BENCH_UNARY(impl_cos, cqf::impl::cos_impl(cqf::wrap_angle(x)), std::cos(x), -10., 10., recursive_sizes);
+CQF_BENCH_UNARY(std_cos, std::cos(x), std::cos(x), -10., 10., batch_sizes);
+
+// inverse normal distribution, checked against the refined scalar quantile
+CQF_BENCH_UNARY(cqf_norm_ppf, cqf::norm_ppf(x), cqf::norm_ppf_refined(x), 1e-6, 1 - 1e-6, batch_sizes);
+CQF_BENCH_UNARY(cqf_norm_ppf_refined, cqf::norm_ppf_refined(x), cqf::norm_ppf_refined(x), 1e-6, 1 - 1e-6,
+                batch_sizes);
+CQF_BENCH_SIMD(simd_norm_ppf, cqf::simd::norm_ppf, cqf::norm_ppf_refined(x), 1e-6, 1 - 1e-6);
+
+// integral power
+CQF_BENCH_UNARY(cqf_power, cqf::power(x, 13), std::pow(x, 13), 0.5, 1.5, batch_sizes);
+CQF_BENCH_UNARY(std_power, std::pow(x, 13), std::pow(x, 13), 0.5, 1.5, batch_sizes);
+
+// integration of the normal density over [-b, b], counting integrand evaluations
+namespace {
+struct plain_density {
+  size_t *calls;
+  double operator()(double x) const {
+    ++*calls;
+    return std::exp(-x * x / 2);
+  }
+};
+
+struct batch_density {
+  size_t *calls;
+  void operator()(const double *x, double *y, size_t n) const {
+    *calls += n;
+    for (size_t i = 0; i < n; ++i) {
+      y[i] = -x[i] * x[i] / 2;
+    }
+    cqf::simd::exp(y, y, n);
+  }
+};
+
+// type-erased integrand, the only kind integrate accepted before it was templated on the callable
+cqf::univariate_real_func<double> erased_density(size_t *calls) {
+  return plain_density{calls};
+}
+
+template<typename Density, typename Integrator>
+void integral(benchmark::State &state, Density make_density, Integrator integrator) {
+  const double b = static_cast<double>(state.range(0));
+  size_t calls = 0;
+  const auto density = make_density(&calls);
+  double value = 0.;
+  for (auto _ : state) {
+    calls = 0;
+    // the const overload, the mutable one clobbers doubles with some gcc versions
+    const double current = integrator(density, -b, b);
+    benchmark::DoNotOptimize(current);
+    value = current;
+  }
+  state.counters["abs_err"] = std::abs(value / std::sqrt(2 * M_PI) - std::erf(b / std::sqrt(2.)));
+  state.counters["evaluations"] = static_cast<double>(calls);
+}
+
+const auto kronrod = [](const auto &f, double a, double b) { return cqf::integrate(f, a, b); };
+const auto simpson = [](const auto &f, double a, double b) { return cqf::integrate_simpson(f, a, b).value; };
+const auto uniform = [](const auto &f, double a, double b) { return cqf::integrate_uniform(f, a, b); };
+const auto gauss = [](const auto &f, double a, double b) { return cqf::integrate_gauss<48>(f, a, b); };
+const auto plain = [](size_t *calls) { return plain_density{calls}; };
+const auto batch = [](size_t *calls) { return batch_density{calls}; };
+} // namespace
+
+void BM_cqf_integrate(benchmark::State &state) { integral(state, plain, kronrod); }
+BENCHMARK(BM_cqf_integrate)->Arg(4)->Arg(10)->Arg(100);
+
+void BM_cqf_integrate_erased(benchmark::State &state) { integral(state, erased_density, kronrod); }
+BENCHMARK(BM_cqf_integrate_erased)->Arg(4)->Arg(10)->Arg(100);
+
+void BM_cqf_integrate_batch(benchmark::State &state) { integral(state, batch, kronrod); }
+BENCHMARK(BM_cqf_integrate_batch)->Arg(4)->Arg(10)->Arg(100);
+
+void BM_cqf_integrate_simpson(benchmark::State &state) { integral(state, plain, simpson); }
+BENCHMARK(BM_cqf_integrate_simpson)->Arg(4)->Arg(10)->Arg(100);
+
+void BM_cqf_integrate_uniform(benchmark::State &state) { integral(state, plain, uniform); }
+BENCHMARK(BM_cqf_integrate_uniform)->Arg(4)->Arg(10)->Arg(100);
+
+void BM_cqf_integrate_gauss(benchmark::State &state) { integral(state, plain, gauss); }
+BENCHMARK(BM_cqf_integrate_gauss)->Arg(4)->Arg(10)->Arg(100);
+
+// E[e^X] for X ~ N(0, sigma^2) by 32-point Gauss-Hermite, sigma in percent
+void BM_cqf_integrate_gauss_normal(benchmark::State &state) {
+  const double sigma = static_cast<double>(state.range(0)) / 100;
+  const auto payoff = [](double x) { return std::exp(x); };
+  double value = 0.;
+  for (auto _ : state) {
+    const double current = cqf::integrate_gauss_normal<32>(payoff, 0., sigma);
+    benchmark::DoNotOptimize(current);
+    value = current;
+  }
+  state.counters["abs_err"] = std::abs(value - std::exp(sigma * sigma / 2));
+}
+BENCHMARK(BM_cqf_integrate_gauss_normal)->Arg(20)->Arg(100);
+
+// black scholes
+namespace {
+struct chain {
+  std::vector<double> S, K, T, r, q, sigma, price, implied;
+  std::unique_ptr<bool[]> call;
+  size_t n;
+
+  explicit chain(size_t n) : S(n, 100.), K(n), T(n), r(n, 0.03), q(n, 0.01), sigma(n), price(n), implied(n),
+                             call(new bool[n]), n(n) {
+    for (size_t i = 0; i < n; ++i) {
+      K[i] = 50. + 100. * static_cast<double>(i) / static_cast<double>(n);
+      T[i] = 0.1 + static_cast<double>(i % 20) / 10.;
+      sigma[i] = 0.1 + static_cast<double>(i % 7) / 20.;
+      call[i] = K[i] >= 100.;
+      price[i] = call[i] ? cqf::call_vanilla<double>(S[i], K[i], T[i], r[i], q[i], sigma[i]).premium()
+                         : cqf::put_vanilla<double>(S[i], K[i], T[i], r[i], q[i], sigma[i]).premium();
+    }
+  }
+
+  cqf::call_vanilla<double> option(size_t i) const {
+    return cqf::call_vanilla<double>(S[i], K[i], T[i], r[i], q[i], sigma[i]);
+  }
+
+  cqf::vanilla_chain<double> view() const {
+    return {S.data(), K.data(), T.data(), r.data(), q.data(), sigma.data(), call.get(), n};
+  }
+};
+
+double std_black_scholes(double S, double K, double T, double r, double q, double sigma) {
+  const double d1 = (std::log(S / K) + (r - q + 0.5 * sigma * sigma) * T) / (sigma * std::sqrt(T));
+  const double d2 = d1 - sigma * std::sqrt(T);
+  return S * std::exp(-q * T) * 0.5 * std::erfc(-d1 / std::sqrt(2.))
+      - K * std::exp(-r * T) * 0.5 * std::erfc(-d2 / std::sqrt(2.));
+}
+} // namespace
+
+void BM_call_premium(benchmark::State &state) {
+  const chain c(static_cast<size_t>(state.range(0)));
+  std::vector<double> y(c.n);
+  for (auto _ : state) {
+    for (size_t i = 0; i < c.n; ++i) y[i] = c.option(i).premium();
+    benchmark::DoNotOptimize(y.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.n));
+}
+BENCHMARK(BM_call_premium)->Apply(batch_sizes);
+
+void BM_std_premium(benchmark::State &state) {
+  const chain c(static_cast<size_t>(state.range(0)));
+  std::vector<double> y(c.n);
+  for (auto _ : state) {
+    for (size_t i = 0; i < c.n; ++i) y[i] = std_black_scholes(c.S[i], c.K[i], c.T[i], c.r[i], c.q[i], c.sigma[i]);
+    benchmark::DoNotOptimize(y.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.n));
+}
+BENCHMARK(BM_std_premium)->Apply(batch_sizes);
+
+void BM_call_greeks(benchmark::State &state) {
+  const chain c(static_cast<size_t>(state.range(0)));
+  std::vector<double> y(c.n);
+  for (auto _ : state) {
+    for (size_t i = 0; i < c.n; ++i) {
+      const auto option = c.option(i);
+      y[i] = option.premium() + option.delta() + option.gamma() + option.vega() + option.theta() + option.rho();
+    }
+    benchmark::DoNotOptimize(y.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.n));
+}
+BENCHMARK(BM_call_greeks)->Apply(batch_sizes);
+
+void BM_call_evaluate(benchmark::State &state) {
+  const chain c(static_cast<size_t>(state.range(0)));
+  std::vector<cqf::greeks<double>> y(c.n);
+  for (auto _ : state) {
+    for (size_t i = 0; i < c.n; ++i) y[i] = c.option(i).evaluate();
+    benchmark::DoNotOptimize(y.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.n));
+}
+BENCHMARK(BM_call_evaluate)->Apply(batch_sizes);
+
+// premium and its six first order sensitivities by a reverse sweep over a tape rewound for every option
+void BM_call_aad(benchmark::State &state) {
+  using var = cqf::var<double>;
+  const chain c(static_cast<size_t>(state.range(0)));
+  std::vector<double> y(c.n);
+  cqf::tape<double> tape;
+  for (auto _ : state) {
+    for (size_t i = 0; i < c.n; ++i) {
+      tape.rewind();
+      const var S = tape.variable(c.S[i]), K = tape.variable(c.K[i]), T = tape.variable(c.T[i]);
+      const var r = tape.variable(c.r[i]), q = tape.variable(c.q[i]), sigma = tape.variable(c.sigma[i]);
+      const var premium = cqf::call_vanilla<var>(S, K, T, r, q, sigma).premium();
+      tape.propagate(premium);
+      y[i] = premium.value() + tape.adjoint(S) + tape.adjoint(K) + tape.adjoint(T) + tape.adjoint(r)
+          + tape.adjoint(q) + tape.adjoint(sigma);
+    }
+    benchmark::DoNotOptimize(y.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.n));
+}
+BENCHMARK(BM_call_aad)->Apply(batch_sizes);
+
+// premium and its six first order sensitivities in one forward evaluation
+void BM_call_dual(benchmark::State &state) {
+  using dual = cqf::dual<double, 6>;
+  const chain c(static_cast<size_t>(state.range(0)));
+  std::vector<double> y(c.n);
+  for (auto _ : state) {
+    for (size_t i = 0; i < c.n; ++i) {
+      const dual premium = cqf::call_vanilla<dual>(dual::variable(c.S[i], 0), dual::variable(c.K[i], 1),
+                                                   dual::variable(c.T[i], 2), dual::variable(c.r[i], 3),
+                                                   dual::variable(c.q[i], 4), dual::variable(c.sigma[i], 5)).premium();
+      y[i] = premium.value() + premium.derivative(0) + premium.derivative(1) + premium.derivative(2)
+          + premium.derivative(3) + premium.derivative(4) + premium.derivative(5);
+    }
+    benchmark::DoNotOptimize(y.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.n));
+}
+BENCHMARK(BM_call_dual)->Apply(batch_sizes);
+
+// reference premiums in a wider type, reporting the largest relative error of the double ones against them
+template<typename Float>
+void reference_premium(benchmark::State &state) {
+  const chain c(static_cast<size_t>(state.range(0)));
+  std::vector<Float> y(c.n);
+  for (auto _ : state) {
+    for (size_t i = 0; i < c.n; ++i) {
+      y[i] = cqf::call_vanilla<Float>(c.S[i], c.K[i], c.T[i], c.r[i], c.q[i], c.sigma[i]).premium();
+    }
+    benchmark::DoNotOptimize(y.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.n));
+  double err = 0.;
+  for (size_t i = 0; i < c.n; ++i) {
+    const double reference = static_cast<double>(y[i]);
+    if (reference > 1e-3) err = std::max(err, std::abs(c.option(i).premium() - reference) / reference);
+  }
+  state.counters["max_rel_err"] = err;
+}
+
+void BM_call_premium_long_double(benchmark::State &state) { reference_premium<long double>(state); }
+BENCHMARK(BM_call_premium_long_double)->Apply(batch_sizes);
+
+#if CQF_HAS_FLOAT128
+void BM_call_premium_float128(benchmark::State &state) { reference_premium<__float128>(state); }
+BENCHMARK(BM_call_premium_float128)->Apply(batch_sizes);
+#endif
+
+void BM_price_chain(benchmark::State &state) {
+  const chain c(static_cast<size_t>(state.range(0)));
+  std::vector<double> premium(c.n), delta(c.n), gamma(c.n), vega(c.n), theta(c.n), rho(c.n);
+  const cqf::vanilla_chain_greeks<double>
+      out{premium.data(), delta.data(), gamma.data(), vega.data(), theta.data(), rho.data()};
+  for (auto _ : state) {
+    cqf::price_chain(c.view(), out);
+    benchmark::DoNotOptimize(premium.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.n));
+}
+BENCHMARK(BM_price_chain)->Apply(batch_sizes);
+
+void BM_call_implied(benchmark::State &state) {
+  const chain c(static_cast<size_t>(state.range(0)));
+  std::vector<double> y(c.n);
+  for (auto _ : state) {
+    for (size_t i = 0; i < c.n; ++i) {
+      y[i] = c.call[i] ? cqf::call_vanilla<double>::implied(c.S[i], c.K[i], c.T[i], c.r[i], c.q[i], c.price[i])
+          .implied_volatility()
+                       : cqf::put_vanilla<double>::implied(c.S[i], c.K[i], c.T[i], c.r[i], c.q[i], c.price[i])
+          .implied_volatility();
+    }
+    benchmark::DoNotOptimize(y.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.n));
+  double err = 0.;
+  for (size_t i = 0; i < c.n; ++i) err = std::max(err, std::abs(y[i] - c.sigma[i]) / c.sigma[i]);
+  state.counters["max_rel_err"] = err;
+}
+BENCHMARK(BM_call_implied)->Apply(batch_sizes);
+
+void BM_implied_chain(benchmark::State &state) {
+  chain c(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    cqf::implied_chain(c.view(), c.price.data(), c.implied.data());
+    benchmark::DoNotOptimize(c.implied.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.n));
+}
+BENCHMARK(BM_implied_chain)->Apply(batch_sizes);
+
+// coupon bonds
+void BM_coupon_with_price(benchmark::State &state) {
+  const double T = static_cast<double>(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cqf::coupon_bond<double>::with_price(T, 4., 102.).yield_to_maturity());
+  }
+}
+BENCHMARK(BM_coupon_with_price)->Arg(3)->Arg(10)->Arg(30);
+
+void BM_coupon_duration(benchmark::State &state) {
+  const double T = static_cast<double>(state.range(0));
+  const cqf::coupon_bond<double> bond(T, 4., 0.035);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bond.duration());
+  }
+}
+BENCHMARK(BM_coupon_duration)->Arg(3)->Arg(10)->Arg(30);
+
+void BM_coupon_analytics(benchmark::State &state) {
+  const double T = static_cast<double>(state.range(0));
+  const cqf::coupon_bond<double> bond(T, 4., 0.035);
+  for (auto _ : state) {
+    const auto current = bond.analytics();
+    benchmark::DoNotOptimize(current);
+  }
+}
+BENCHMARK(BM_coupon_analytics)->Arg(3)->Arg(10)->Arg(30);
+
+// cached schedules of semiannual bonds from 1 to 30 years, items being bonds
+void BM_bond_schedule(benchmark::State &state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  std::vector<cqf::coupon_bond<double>> bonds;
+  for (size_t i = 0; i < n; ++i) {
+    bonds.emplace_back(1. + static_cast<double>(i % 30), 4., 0.035);
+  }
+  const cqf::bond_schedule<double> schedule(bonds);
+  std::vector<double> price(n), dv01(n), duration(n), convexity(n);
+  const cqf::bond_chain_analytics<double> out{price.data(), dv01.data(), duration.data(), convexity.data()};
+  for (auto _ : state) {
+    schedule.evaluate(out);
+    benchmark::DoNotOptimize(price.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+BENCHMARK(BM_bond_schedule)->Arg(4096);
+
+// intraday rebuild of a curve of deposits and quarterly spaced par swaps, items being instruments
+void BM_curve_bootstrap(benchmark::State &state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  std::vector<cqf::curve_instrument<double>> quotes;
+  for (size_t k = 1; k <= n; ++k) {
+    const double T = static_cast<double>(k) / 8.;
+    const double rate = 0.01 + 0.03 * (1. - std::exp(-T / 5.));
+    quotes.push_back(k <= 4 ? cqf::curve_instrument<double>::deposit(T, rate) : cqf::curve_instrument<double>::swap(T, rate));
+  }
+  cqf::yield_curve<double> curve(quotes.data(), quotes.size());
+  for (auto _ : state) {
+    curve.bootstrap(quotes.data(), quotes.size());
+    const double current = curve.discount(static_cast<double>(n) / 16.);
+    benchmark::DoNotOptimize(current);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+BENCHMARK(BM_curve_bootstrap)->Arg(50)->Arg(500);
+
+void BM_curve_discount(benchmark::State &state) {
+  std::vector<cqf::curve_instrument<double>> quotes;
+  for (size_t k = 1; k <= 500; ++k) {
+    quotes.push_back(cqf::curve_instrument<double>::swap(static_cast<double>(k) / 8., 0.03));
+  }
+  const cqf::yield_curve<double> swaps(quotes.data(), quotes.size());
+  double t = static_cast<double>(state.range(0)) / 1000.;
+  for (auto _ : state) {
+    const double current = swaps.discount(t);
+    benchmark::DoNotOptimize(current);
+    t = t > 60. ? 0.001 : t + 0.37;
+  }
+}
+BENCHMARK(BM_curve_discount)->Arg(1);
+
+// COS method over a chain of strikes, items being strikes
+template<typename Model>
+void cos_chain(benchmark::State &state, const Model &model) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  std::vector<double> K(n), price(n);
+  for (size_t i = 0; i < n; ++i) {
+    K[i] = 50. + 100. * static_cast<double>(i) / static_cast<double>(n);
+  }
+  for (auto _ : state) {
+    cqf::cos_price(model, true, 100., K.data(), n, 1., 0.05, 0.02, price.data());
+    benchmark::DoNotOptimize(price.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+void BM_cos_gbm(benchmark::State &state) { cos_chain(state, cqf::gbm<double>{0.25}); }
+BENCHMARK(BM_cos_gbm)->Arg(1)->Arg(200);
+
+void BM_cos_heston(benchmark::State &state) {
+  cos_chain(state, cqf::heston<double>{1.5768, 0.0398, 0.5751, -0.5711, 0.0175});
+}
+BENCHMARK(BM_cos_heston)->Arg(1)->Arg(200);
+
+void BM_cos_variance_gamma(benchmark::State &state) { cos_chain(state, cqf::variance_gamma<double>{0.12, 0.2, -0.14}); }
+BENCHMARK(BM_cos_variance_gamma)->Arg(1)->Arg(200);
+
+// American put, the argument being the number of spot intervals, the spot a tenth of it to defeat folding
+void BM_finite_difference(benchmark::State &state) {
+  cqf::fd_settings settings;
+  settings.space = static_cast<size_t>(state.range(0));
+  const double S = static_cast<double>(state.range(0)) / 10.;
+  for (auto _ : state) {
+    const auto current = cqf::finite_difference(false, S, 40., 1., 0.06, 0., 0.2, settings);
+    benchmark::DoNotOptimize(current);
+  }
+}
+BENCHMARK(BM_finite_difference)->Arg(200)->Arg(400);
+
+// American put, the argument being the number of steps
+void BM_lattice_leisen_reimer(benchmark::State &state) {
+  cqf::lattice_settings settings;
+  settings.steps = static_cast<size_t>(state.range(0));
+  for (auto _ : state) {
+    const auto current = cqf::lattice(false, 36., 40., 1., 0.06, 0., 0.2, settings);
+    benchmark::DoNotOptimize(current);
+  }
+}
+BENCHMARK(BM_lattice_leisen_reimer)->Arg(200)->Arg(2000);
+
+void BM_lattice_crr(benchmark::State &state) {
+  cqf::lattice_settings settings;
+  settings.tree = cqf::lattice_tree::crr;
+  settings.steps = static_cast<size_t>(state.range(0));
+  for (auto _ : state) {
+    const auto current = cqf::lattice(false, 36., 40., 1., 0.06, 0., 0.2, settings);
+    benchmark::DoNotOptimize(current);
+  }
+}
+BENCHMARK(BM_lattice_crr)->Arg(200)->Arg(2000);
+
+// portfolio engine, second argument being the number of workers
+void BM_revalue(benchmark::State &state) {
+  const chain c(static_cast<size_t>(state.range(0)));
+  cqf::portfolio<double> book;
+  for (size_t i = 0; i < c.n; ++i) {
+    book.calls.push_back({c.option(i), 1.});
+    book.bonds.push_back({cqf::coupon_bond<double>(c.T[i] * 10., 4., 0.035), 1.});
+  }
+  cqf::thread_pool pool(static_cast<size_t>(state.range(1)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cqf::revalue(book, pool));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * 2 * c.n));
+}
+BENCHMARK(BM_revalue)->ArgsProduct({{4096, 65536}, {1, 2, 4, 8}})->UseRealTime();
+
+// incremental revaluation of a book of options on 100 spots and of bonds, ticking one spot then repricing,
+// against the full revaluation above
+void BM_revaluation_tick(benchmark::State &state) {
+  const chain c(static_cast<size_t>(state.range(0)));
+  const double knots[] = {0.5, 1., 2., 5., 10., 30.}, zeros[] = {0.02, 0.022, 0.025, 0.03, 0.033, 0.035};
+  cqf::revaluation<double> book(knots, zeros, 6);
+  for (size_t s = 0; s < 100; ++s) {
+    book.add_spot(100.);
+  }
+  const size_t vol = book.add_vol(0.2);
+  for (size_t i = 0; i < c.n; ++i) {
+    book.add_option(true, i % 100, vol, c.K[i], c.T[i], 0.01, 1.);
+    book.add_bond(cqf::coupon_bond<double>(c.T[i] * 10., 4., 0.035), 1.);
+  }
+  size_t spot = 0;
+  double S = 100.;
+  for (auto _ : state) {
+    book.set_spot(spot, S);
+    const auto current = book.risk();
+    benchmark::DoNotOptimize(current);
+    spot = spot == 99 ? 0 : spot + 1;
+    S = S > 110. ? 90. : S + 0.01;
+  }
+}
+BENCHMARK(BM_revaluation_tick)->Arg(4096)->Arg(65536);
+
+// monte carlo, items being paths, second argument being the number of workers
+void BM_monte_carlo_asian(benchmark::State &state) {
+  cqf::mc_settings settings;
+  settings.paths = static_cast<size_t>(state.range(0));
+  settings.control_strike = 100.;
+  cqf::thread_pool pool(static_cast<size_t>(state.range(1)));
+  cqf::mc_result<double> result{};
+  for (auto _ : state) {
+    const auto current = cqf::monte_carlo(cqf::asian<double, cqf::option_side::call>{100.}, 100., 1., 0.03, 0.01,
+                                          0.2, settings, pool);
+    benchmark::DoNotOptimize(current);
+    result = current;
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * result.paths));
+  state.counters["std_error"] = result.error;
+}
+BENCHMARK(BM_monte_carlo_asian)->ArgsProduct({{16384}, {1, 4}})->UseRealTime();
+
+void BM_quasi_monte_carlo_asian(benchmark::State &state) {
+  cqf::mc_settings settings;
+  settings.paths = static_cast<size_t>(state.range(0));
+  settings.control_strike = 100.;
+  settings.quasi = true;
+  cqf::thread_pool pool(static_cast<size_t>(state.range(1)));
+  cqf::mc_result<double> result{};
+  for (auto _ : state) {
+    const auto current = cqf::monte_carlo(cqf::asian<double, cqf::option_side::call>{100.}, 100., 1., 0.03, 0.01,
+                                          0.2, settings, pool);
+    benchmark::DoNotOptimize(current);
+    result = current;
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * result.paths));
+}
+BENCHMARK(BM_quasi_monte_carlo_asian)->ArgsProduct({{16384}, {1, 4}})->UseRealTime();
+
+void BM_sobol(benchmark::State &state) {
+  cqf::sobol<cqf::sobol_dimensions> sequence;
+  double u[cqf::sobol_dimensions];
+  for (auto _ : state) {
+    sequence.next(u);
+    benchmark::DoNotOptimize(u);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * cqf::sobol_dimensions));
+}
+BENCHMARK(BM_sobol);
+
+void BM_normal_fill(benchmark::State &state) {
+  std::vector<double> z(static_cast<size_t>(state.range(0)));
+  const cqf::philox rng(0);
+  uint64_t stream = 0;
+  for (auto _ : state) {
+    cqf::normal_fill(rng, stream++, z.data(), z.size());
+    benchmark::DoNotOptimize(z.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * z.size()));
+}
+BENCHMARK(BM_normal_fill)->Arg(64)->Arg(4096);
+
+BENCHMARK_MAIN();
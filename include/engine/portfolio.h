@@ -0,0 +1,182 @@
+//
+// Created by mamin on 12/22/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_ENGINE_PORTFOLIO_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_ENGINE_PORTFOLIO_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "math/traits.h"
+#include "math/basic.h"
+#include "model/black_scholes.h"
+#include "model/coupon_bond.h"
+#include "engine/thread_pool.h"
+
+namespace cqf {
+/**
+ * a holding of an instrument, negative quantities being short.
+ *
+ * @tparam Float
+ * @tparam Instrument
+ */
+template<typename Float, typename Instrument, typename = floating_guard<Float>>
+struct position {
+  Instrument instrument;
+  Float quantity;
+};
+
+/**
+ * a book of European plain vanilla options and coupon bonds.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct portfolio {
+  std::vector<position<Float, call_vanilla<Float>>> calls;
+  std::vector<position<Float, put_vanilla<Float>>> puts;
+  std::vector<position<Float, coupon_bond<Float>>> bonds;
+};
+
+/**
+ * aggregate value and risk of a portfolio, every quantity weighted by position size.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct portfolio_risk {
+  Float value;    // option premiums and bond prices
+  Float delta;    // dV / dS of options
+  Float gamma;    // d^2V / dS^2 of options
+  Float vega;     // dV / d sigma of options
+  Float theta;    // dV / dt of options
+  Float rho;      // dV / dr of options
+  Float dv01;     // -dB / dY of bonds per basis point
+
+  inline constexpr
+  portfolio_risk &
+  operator+=(const portfolio_risk &other) noexcept {
+    value += other.value;
+    delta += other.delta;
+    gamma += other.gamma;
+    vega += other.vega;
+    theta += other.theta;
+    rho += other.rho;
+    dv01 += other.dv01;
+    return *this;
+  }
+};
+
+namespace impl {
+/**
+ * accumulates the risk of positions [begin, end) of options of one side.
+ *
+ * @tparam Float
+ * @tparam Side
+ * @param positions
+ * @param begin
+ * @param end
+ * @return
+ */
+template<typename Float, option_side Side, typename = floating_guard<Float>>
+inline static constexpr
+portfolio_risk<Float>
+option_risk(const std::vector<position<Float, vanilla<Float, Side>>> &positions, size_t begin, size_t end) noexcept {
+  portfolio_risk<Float> risk{};
+  for (size_t i = begin; i < end; ++i) {
+    const greeks<Float> g = positions[i].instrument.evaluate();
+    const Float quantity = positions[i].quantity;
+    risk.value += quantity * g.premium;
+    risk.delta += quantity * g.delta;
+    risk.gamma += quantity * g.gamma;
+    risk.vega += quantity * g.vega;
+    risk.theta += quantity * g.theta;
+    risk.rho += quantity * g.rho;
+  }
+  return risk;
+}
+
+/**
+ * accumulates the value and DV01 of bond positions [begin, end).
+ * DV01 = modified duration * price / 10000.
+ *
+ * @tparam Float
+ * @param positions
+ * @param begin
+ * @param end
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+portfolio_risk<Float>
+bond_risk(const std::vector<position<Float, coupon_bond<Float>>> &positions, size_t begin, size_t end) noexcept {
+  portfolio_risk<Float> risk{};
+  for (size_t i = begin; i < end; ++i) {
+    const bond_analytics<Float> a = positions[i].instrument.analytics();
+    risk.value += positions[i].quantity * a.price;
+    risk.dv01 += positions[i].quantity * a.dv01;
+  }
+  return risk;
+}
+
+/**
+ * number of chunks of CQF_ENGINE_CHUNK positions covering n positions.
+ *
+ * @param n
+ * @return
+ */
+inline static constexpr
+size_t
+chunks(size_t n) noexcept {
+  return (n + CQF_ENGINE_CHUNK - 1) / CQF_ENGINE_CHUNK;
+}
+} // namespace impl
+
+/**
+ * revalues a whole portfolio in parallel.
+ * <br/>
+ * Calls, puts and bonds are cut into chunks of CQF_ENGINE_CHUNK positions, which the pool prices independently,
+ * each chunk accumulating its own partial risk in position order.
+ * The partials are then summed in chunk order on the calling thread,
+ * so that the result is bitwise identical for any number of threads and any schedule.
+ *
+ * @tparam Float
+ * @param book
+ * @param pool
+ * @return aggregate value and risk
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static
+portfolio_risk<Float>
+revalue(const portfolio<Float> &book, thread_pool &pool) {
+  const size_t calls = impl::chunks(book.calls.size());
+  const size_t puts = impl::chunks(book.puts.size());
+  const size_t bonds = impl::chunks(book.bonds.size());
+  std::vector<portfolio_risk<Float>> partials(calls + puts + bonds);
+
+  pool.parallel_for(partials.size(), [&](size_t chunk) {
+    const auto range = [](size_t c, size_t n) {
+      return std::make_pair(c * CQF_ENGINE_CHUNK, min((c + 1) * CQF_ENGINE_CHUNK, n));
+    };
+    if (chunk < calls) {
+      const auto[begin, end] = range(chunk, book.calls.size());
+      partials[chunk] = impl::option_risk(book.calls, begin, end);
+    } else if (chunk < calls + puts) {
+      const auto[begin, end] = range(chunk - calls, book.puts.size());
+      partials[chunk] = impl::option_risk(book.puts, begin, end);
+    } else {
+      const auto[begin, end] = range(chunk - calls - puts, book.bonds.size());
+      partials[chunk] = impl::bond_risk(book.bonds, begin, end);
+    }
+  });
+
+  portfolio_risk<Float> risk{};
+  for (const auto &partial : partials) {
+    risk += partial;
+  }
+  return risk;
+}
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_ENGINE_PORTFOLIO_H_
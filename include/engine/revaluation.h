@@ -0,0 +1,382 @@
+//
+// Created by mamin on 12/31/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_ENGINE_REVALUATION_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_ENGINE_REVALUATION_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "math/traits.h"
+#include "math/basic.h"
+#include "math/exp.h"
+#include "model/black_scholes.h"
+#include "model/coupon_bond.h"
+#include "model/yield_curve.h"
+#include "engine/portfolio.h"
+
+namespace cqf {
+namespace impl {
+/**
+ * adds the risk of a holding of an option to an aggregate, or removes it with a quantity of the opposite sign.
+ *
+ * @tparam Float
+ * @param risk
+ * @param g
+ * @param quantity
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+void
+accumulate(portfolio_risk<Float> &risk, const greeks<Float> &g, Float quantity) noexcept {
+  risk.value += quantity * g.premium;
+  risk.delta += quantity * g.delta;
+  risk.gamma += quantity * g.gamma;
+  risk.vega += quantity * g.vega;
+  risk.theta += quantity * g.theta;
+  risk.rho += quantity * g.rho;
+}
+} // namespace impl
+
+/**
+ * book of European plain vanilla options and coupon bonds revalued incrementally as market data ticks.
+ * <br/>
+ * Market inputs are spots and volatilities, each shared by any number of options, and the zero rates
+ * at the knots of a curve log-linear in discount factors, on which options read their rate to maturity
+ * and bonds discount their cash flows. Every input keeps the list of the instruments depending on it:
+ * an option on its spot, its volatility and the two knots around its maturity, a bond on every knot
+ * up to its maturity. Moving an input marks its dependents, and risk reprices the marked instruments only,
+ * replacing their previous contribution to the aggregate risk, so that a tick costs in proportion
+ * to the instruments it touches rather than to the book.
+ * <br/>
+ * Between two calls of risk, estimate follows the value of the book from the Greeks of the last pricing:
+ * delta and gamma for spots, vega for volatilities, rho for options and key rate sensitivities
+ * dB / dz for bonds on curve knots, at a few multiply-adds per dependent.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+class revaluation {
+ private:
+  struct option_entry {
+    bool call;
+    size_t spot, vol, knot;   // market inputs, the knot starting the segment of maturity on the curve
+    Float K, T, q, quantity;
+    Float lower, upper;       // weights of the knots in -ln P(T)
+    greeks<Float> g;          // as of the last pricing
+  };
+
+  struct bond_entry {
+    coupon_bond<Float> bond;
+    Float quantity;
+    size_t offset, knots;     // key rate sensitivities to knots 1, ..., knots at key_rates[offset...]
+    bond_analytics<Float> a;  // as of the last pricing
+  };
+
+  std::vector<Float> spots, vols, zeros;         // market inputs, zero rates of the knots from 0
+  yield_curve<Float> curve;                      // knots, interpolating as the curve the book is discounted on
+  std::vector<Float> priced_spots;                // spots as of the last pricing of their dependents
+  std::vector<option_entry> options;
+  std::vector<bond_entry> bonds;
+  std::vector<Float> key_rates;                  // dB / dz of every bond at its knots, one bond after the other
+  std::vector<std::vector<size_t>> spot_options, vol_options, knot_options, knot_bonds;
+  std::vector<uint8_t> option_marked, bond_marked;
+  std::vector<size_t> marked_options, marked_bonds;
+  std::vector<Float> flow_times, flow_amounts;   // scratch for bond cash flows
+  portfolio_risk<Float> totals{};
+  Float estimated = 0;
+
+  inline
+  void
+  mark_option(size_t o) {
+    if (!option_marked[o]) {
+      option_marked[o] = 1;
+      marked_options.push_back(o);
+    }
+  }
+
+  inline
+  void
+  mark_bond(size_t b) {
+    if (!bond_marked[b]) {
+      bond_marked[b] = 1;
+      marked_bonds.push_back(b);
+    }
+  }
+
+  /**
+   * weights of the zero rates of the two knots around t in -ln P(t) = lower z_i + upper z_i+1,
+   * i being the segment of t on the curve, see yield_curve::interpolation.
+   */
+  inline
+  void
+  weights(Float t, size_t &knot, Float &lower, Float &upper) const noexcept {
+    Float w = 0;
+    knot = curve.interpolation(t, w);
+    lower = (1 - w) * curve.knot(knot);
+    upper = w * curve.knot(knot + 1);
+  }
+
+  inline
+  void
+  price(option_entry &o) const noexcept {
+    const Float r = (o.lower * zeros[o.knot] + o.upper * zeros[o.knot + 1]) / o.T;
+    o.g = impl::black_scholes_greeks(o.call ? static_cast<Float>(1) : static_cast<Float>(-1),
+                                     spots[o.spot], o.K, o.T, r, o.q, vols[o.vol]);
+  }
+
+  /**
+   * prices a bond in a single pass over its cash flows, along with its key rate sensitivities,
+   * every payment depending on the two knots around it.
+   */
+  inline
+  void
+  price(bond_entry &b) {
+    const size_t n = b.bond.cash_flow_count();
+    flow_times.resize(n);
+    flow_amounts.resize(n);
+    b.bond.cash_flows(flow_times.data(), flow_amounts.data());
+    Float *key = key_rates.data() + b.offset;  // knot k at key[k - 1]
+    std::fill(key, key + b.knots, static_cast<Float>(0));
+
+    compensated_sum<Float> B{}, dB{}, d2B{};
+    for (size_t j = 0; j < n; ++j) {
+      const Float t = flow_times[j];
+      size_t i = 0;
+      Float lower = 0, upper = 0;
+      weights(t, i, lower, upper);
+      const Float pv = flow_amounts[j] * exp(-(lower * zeros[i] + upper * zeros[i + 1]));
+      B += pv;
+      dB += t * pv;
+      d2B += t * t * pv;
+      if (i > 0) {
+        key[i - 1] -= lower * pv;
+      }
+      key[i] -= upper * pv;
+    }
+    b.a = impl::bond_analytics_of(B.value(), dB.value(), d2B.value());
+  }
+
+  inline
+  void
+  accumulate(const bond_entry &b, Float sign) noexcept {
+    totals.value += sign * b.quantity * b.a.price;
+    totals.dv01 += sign * b.quantity * b.a.dv01;
+  }
+
+ public:
+  /**
+   * constructor.
+   *
+   * @param knot_times increasing positive times of the knots of the curve
+   * @param zero_rates continuously compounded zero rates at the knots
+   * @param n number of knots, at least one
+   */
+  inline
+  revaluation(const Float *knot_times, const Float *zero_rates, size_t n)
+      : zeros{0}, knot_options(n + 1), knot_bonds(n + 1) {
+    zeros.insert(zeros.end(), zero_rates, zero_rates + n);
+    std::vector<Float> discount(n);
+    for (size_t i = 0; i < n; ++i) {
+      discount[i] = exp(-zero_rates[i] * knot_times[i]);
+    }
+    curve = yield_curve<Float>(knot_times, discount.data(), n);
+  }
+
+  /**
+   * adds an underlying.
+   *
+   * @param S spot price
+   * @return identifier of the spot
+   */
+  inline
+  size_t
+  add_spot(Float S) {
+    spots.push_back(S);
+    priced_spots.push_back(S);
+    spot_options.emplace_back();
+    return spots.size() - 1;
+  }
+
+  /**
+   * adds a volatility point.
+   *
+   * @param sigma implied volatility
+   * @return identifier of the volatility
+   */
+  inline
+  size_t
+  add_vol(Float sigma) {
+    vols.push_back(sigma);
+    vol_options.emplace_back();
+    return vols.size() - 1;
+  }
+
+  /**
+   * adds and prices a holding of an option.
+   *
+   * @param call true for calls, false for puts
+   * @param spot identifier of the underlying
+   * @param vol identifier of the volatility
+   * @param K strike price
+   * @param T time to maturity
+   * @param q dividend paying rate of underlying
+   * @param quantity
+   * @return index of the option
+   */
+  inline
+  size_t
+  add_option(bool call, size_t spot, size_t vol, Float K, Float T, Float q, Float quantity) {
+    option_entry o{call, spot, vol, 0, K, T, q, quantity, 0, 0, {}};
+    weights(T, o.knot, o.lower, o.upper);
+    price(o);
+    impl::accumulate(totals, o.g, quantity);
+    estimated += quantity * o.g.premium;
+
+    const size_t index = options.size();
+    options.push_back(o);
+    option_marked.push_back(0);
+    spot_options[spot].push_back(index);
+    vol_options[vol].push_back(index);
+    knot_options[o.knot].push_back(index);
+    knot_options[o.knot + 1].push_back(index);
+    return index;
+  }
+
+  /**
+   * adds and prices a holding of a bond, discounted on the curve.
+   *
+   * @param bond
+   * @param quantity
+   * @return index of the bond
+   */
+  inline
+  size_t
+  add_bond(const coupon_bond<Float> &bond, Float quantity) {
+    size_t knot = 0;
+    Float lower = 0, upper = 0;
+    bond_entry b{bond, quantity, key_rates.size(), 0, {}};
+    weights(bond.maturity(), knot, lower, upper);
+    b.knots = knot + 1;
+    key_rates.resize(key_rates.size() + b.knots);
+    price(b);
+    accumulate(b, 1);
+    estimated += quantity * b.a.price;
+
+    const size_t index = bonds.size();
+    bonds.push_back(b);
+    bond_marked.push_back(0);
+    for (size_t k = 1; k <= b.knots; ++k) {
+      knot_bonds[k].push_back(index);
+    }
+    return index;
+  }
+
+  /**
+   * moves a spot, marking the options on it and estimating their change by delta and gamma.
+   *
+   * @param spot identifier
+   * @param S
+   */
+  inline
+  void
+  set_spot(size_t spot, Float S) {
+    const Float before = spots[spot] - priced_spots[spot], after = S - priced_spots[spot];
+    for (const size_t o : spot_options[spot]) {
+      const greeks<Float> &g = options[o].g;
+      estimated += options[o].quantity * (g.delta * (after - before) + g.gamma * (after * after - before * before) / 2);
+      mark_option(o);
+    }
+    spots[spot] = S;
+  }
+
+  /**
+   * moves a volatility, marking the options on it and estimating their change by vega.
+   *
+   * @param vol identifier
+   * @param sigma
+   */
+  inline
+  void
+  set_vol(size_t vol, Float sigma) {
+    for (const size_t o : vol_options[vol]) {
+      estimated += options[o].quantity * options[o].g.vega * (sigma - vols[vol]);
+      mark_option(o);
+    }
+    vols[vol] = sigma;
+  }
+
+  /**
+   * moves the zero rate of a knot, marking the options and bonds discounted on it
+   * and estimating their change by rho and key rate sensitivities.
+   *
+   * @param knot from 1, knot 0 being today
+   * @param zero_rate
+   */
+  inline
+  void
+  set_rate(size_t knot, Float zero_rate) {
+    const Float dz = zero_rate - zeros[knot];
+    for (const size_t o : knot_options[knot]) {
+      const option_entry &entry = options[o];
+      const Float weight = (entry.knot == knot ? entry.lower : entry.upper) / entry.T;
+      estimated += entry.quantity * entry.g.rho * weight * dz;
+      mark_option(o);
+    }
+    for (const size_t b : knot_bonds[knot]) {
+      estimated += bonds[b].quantity * key_rates[bonds[b].offset + knot - 1] * dz;
+      mark_bond(b);
+    }
+    zeros[knot] = zero_rate;
+  }
+
+  /**
+   * number of instruments to be repriced by the next call of risk.
+   *
+   * @return
+   */
+  inline size_t pending() const { return marked_options.size() + marked_bonds.size(); }
+
+  /**
+   * value of the book estimated from the Greeks of the last pricing, in constant time.
+   *
+   * @return
+   */
+  inline Float estimate() const { return estimated; }
+
+  /**
+   * reprices the instruments depending on inputs moved since the last call,
+   * replacing their contributions to the aggregate risk, and returns it.
+   *
+   * @return aggregate value and risk of the book
+   */
+  inline
+  portfolio_risk<Float>
+  risk() {
+    for (const size_t index : marked_options) {
+      option_entry &o = options[index];
+      impl::accumulate(totals, o.g, -o.quantity);
+      price(o);
+      impl::accumulate(totals, o.g, o.quantity);
+      option_marked[index] = 0;
+    }
+    for (const size_t index : marked_bonds) {
+      bond_entry &b = bonds[index];
+      accumulate(b, -1);
+      price(b);
+      accumulate(b, 1);
+      bond_marked[index] = 0;
+    }
+    marked_options.clear();
+    marked_bonds.clear();
+    priced_spots = spots;
+    estimated = totals.value;
+    return totals;
+  }
+
+};
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_ENGINE_REVALUATION_H_
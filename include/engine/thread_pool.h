@@ -0,0 +1,209 @@
+//
+// Created by mamin on 12/22/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_ENGINE_THREAD_POOL_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_ENGINE_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "math/traits.h"
+
+namespace cqf {
+/**
+ * fixed-size pool of worker threads running indexed tasks with work stealing.
+ * <br/>
+ * Every worker owns a deque of task indices, initially a contiguous share of the job.
+ * A worker takes tasks from the back of its own deque, and once it runs dry steals from the front of the others',
+ * so that uneven tasks, e.g. chunks of long-dated bonds next to chunks of options, still keep every core busy.
+ * The thread calling parallel_for takes part as worker 0, hence a pool of size 1 spawns no thread at all.
+ * A task may call parallel_for on the pool running it, e.g. a pooled revaluation pricing a chain on the same pool:
+ * the nested loop then runs inline on the calling worker, the others being busy with the enclosing job.
+ */
+class thread_pool {
+ private:
+  struct queue {
+    std::mutex lock;
+    std::deque<size_t> tasks;
+  };
+
+  std::vector<std::thread> threads;
+  std::unique_ptr<queue[]> queues;
+  size_t workers;
+
+  std::mutex lock;                     // guards generation and stop, and pairs with both condition variables
+  std::condition_variable wake;        // a new job, or shutdown
+  std::condition_variable done;        // the last task of the job has finished
+  std::mutex submit;                   // serializes concurrent callers of parallel_for
+  const std::function<void(size_t)> *job = nullptr;
+  std::atomic<size_t> pending{0};
+  size_t generation = 0;
+  bool stop = false;
+
+  inline static thread_local const thread_pool *running = nullptr;  // pool whose tasks the thread runs
+
+ public:
+  /**
+   * constructor.
+   *
+   * @param workers number of workers including the calling thread, all hardware threads by default
+   */
+  inline explicit
+  thread_pool(size_t workers = std::thread::hardware_concurrency())
+      : queues(new queue[workers > 0 ? workers : 1]), workers(workers > 0 ? workers : 1) {
+    for (size_t self = 1; self < this->workers; ++self) {
+      threads.emplace_back([this, self] { work(self); });
+    }
+  }
+
+  thread_pool(const thread_pool &) = delete;
+
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  inline
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stop = true;
+    }
+    wake.notify_all();
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  /**
+   * number of workers including the calling thread.
+   *
+   * @return
+   */
+  inline
+  size_t
+  size() const noexcept { return workers; }
+
+  /**
+   * runs func(i) for every i in [0, n) across the pool and returns once all of them have finished.
+   * tasks may run in any order and on any worker, func must not throw.
+   * called from a task of this pool, it runs every task inline on the calling worker.
+   *
+   * @param n number of tasks
+   * @param func
+   */
+  inline
+  void
+  parallel_for(size_t n, const std::function<void(size_t)> &func) {
+    if (n == 0) {
+      return;
+    }
+    if (running == this) {
+      for (size_t i = 0; i < n; ++i) {
+        func(i);
+      }
+      return;
+    }
+    std::lock_guard<std::mutex> serial(submit);
+    job = &func;
+    pending.store(n);
+    // the job pointer is published to the workers by the queue locks
+    for (size_t w = 0; w < workers; ++w) {
+      std::lock_guard<std::mutex> guard(queues[w].lock);
+      for (size_t i = w * n / workers; i < (w + 1) * n / workers; ++i) {
+        queues[w].tasks.push_back(i);
+      }
+    }
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      ++generation;
+    }
+    wake.notify_all();
+
+    const thread_pool *outer = running;
+    running = this;
+    run(0);
+    running = outer;
+    std::unique_lock<std::mutex> guard(lock);
+    done.wait(guard, [this] { return pending.load() == 0; });
+  }
+
+ private:
+  /**
+   * takes the next task, from the back of the worker's own deque or else from the front of another's.
+   *
+   * @param self
+   * @param task
+   * @return false if every deque is empty
+   */
+  inline
+  bool
+  pop(size_t self, size_t &task) {
+    {
+      std::lock_guard<std::mutex> guard(queues[self].lock);
+      if (!queues[self].tasks.empty()) {
+        task = queues[self].tasks.back();
+        queues[self].tasks.pop_back();
+        return true;
+      }
+    }
+    for (size_t k = 1; k < workers; ++k) {
+      queue &victim = queues[(self + k) % workers];
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if (!victim.tasks.empty()) {
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * runs tasks until there is none left to take.
+   *
+   * @param self
+   */
+  inline
+  void
+  run(size_t self) {
+    size_t task;
+    while (pop(self, task)) {
+      (*job)(task);
+      if (pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> guard(lock);
+        done.notify_all();
+      }
+    }
+  }
+
+  /**
+   * body of the spawned threads, sleeping between jobs.
+   *
+   * @param self
+   */
+  inline
+  void
+  work(size_t self) {
+    running = this;
+    size_t seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        wake.wait(guard, [this, seen] { return stop || generation != seen; });
+        if (stop) {
+          return;
+        }
+        seen = generation;
+      }
+      run(self);
+    }
+  }
+};
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_ENGINE_THREAD_POOL_H_
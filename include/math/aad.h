@@ -0,0 +1,347 @@
+//
+// Created by mamin on 12/31/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_AAD_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_AAD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "traits.h"
+#include "basic.h"
+#include "constants.h"
+#include "power.h"
+#include "exp.h"
+#include "log.h"
+#include "sqrt.h"
+#include "erf.h"
+#include "trig.h"
+#include "norm.h"
+
+namespace cqf {
+template<typename Float, typename = floating_guard<Float>>
+class tape;
+
+/**
+ * number recorded on a tape for reverse mode algorithmic differentiation.
+ * <br/>
+ * A var holds its value and the index of the node recording how it was computed, and behaves as Float
+ * in arithmetic, comparisons and the functions of this library, so that a model templated on Float,
+ * such as vanilla or coupon_bond, runs unchanged on vars. Values not computed from variables of a tape,
+ * literals included, are constants: they carry no tape and record nothing.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+class var {
+ private:
+  Float x;              // value
+  uint32_t node;        // node of the tape, 0 for constants
+  tape<Float> *owner;   // tape recording the var, null for constants
+
+ public:
+  /**
+   * constant.
+   *
+   * @param value
+   */
+  inline constexpr
+  var(Float value = 0) noexcept : x(value), node(0), owner(nullptr) {}
+
+  /**
+   * var recorded at a node of a tape, see tape::variable.
+   *
+   * @param value
+   * @param node
+   * @param owner
+   */
+  inline constexpr
+  var(Float value, uint32_t node, tape<Float> *owner) noexcept : x(value), node(node), owner(owner) {}
+
+  inline constexpr Float value() const { return x; }
+
+  inline constexpr uint32_t index() const { return node; }
+
+  /**
+   * value converted to an arithmetic type, the derivatives being lost.
+   *
+   * @tparam Arithmetic
+   * @return
+   */
+  template<typename Arithmetic, typename = std::enable_if_t<std::is_arithmetic_v<Arithmetic>>>
+  inline explicit constexpr
+  operator Arithmetic() const { return static_cast<Arithmetic>(x); }
+
+  /**
+   * records a function of one var, given its derivative.
+   *
+   * @param value
+   * @param a
+   * @param da
+   * @return
+   */
+  inline static
+  var
+  unary(Float value, const var &a, Float da) {
+    return a.owner ? a.owner->record(value, a.node, da, 0, 0) : var(value);
+  }
+
+  /**
+   * records a function of two vars, given its partial derivatives.
+   *
+   * @param value
+   * @param a
+   * @param da
+   * @param b
+   * @param db
+   * @return
+   */
+  inline static
+  var
+  binary(Float value, const var &a, Float da, const var &b, Float db) {
+    tape<Float> *t = a.owner ? a.owner : b.owner;
+    return t ? t->record(value, a.node, da, b.node, db) : var(value);
+  }
+
+  inline friend var operator+(const var &a) { return a; }
+  inline friend var operator-(const var &a) { return unary(-a.x, a, -1); }
+  inline friend var operator+(const var &a, const var &b) { return binary(a.x + b.x, a, 1, b, 1); }
+  inline friend var operator-(const var &a, const var &b) { return binary(a.x - b.x, a, 1, b, -1); }
+  inline friend var operator*(const var &a, const var &b) { return binary(a.x * b.x, a, b.x, b, a.x); }
+  inline friend var operator/(const var &a, const var &b) {
+    const Float value = a.x / b.x;
+    return binary(value, a, 1 / b.x, b, -value / b.x);
+  }
+
+  inline var &operator+=(const var &b) { return *this = *this + b; }
+  inline var &operator-=(const var &b) { return *this = *this - b; }
+  inline var &operator*=(const var &b) { return *this = *this * b; }
+  inline var &operator/=(const var &b) { return *this = *this / b; }
+
+  inline friend constexpr bool operator==(const var &a, const var &b) { return a.x == b.x; }
+  inline friend constexpr bool operator!=(const var &a, const var &b) { return a.x != b.x; }
+  inline friend constexpr bool operator<(const var &a, const var &b) { return a.x < b.x; }
+  inline friend constexpr bool operator<=(const var &a, const var &b) { return a.x <= b.x; }
+  inline friend constexpr bool operator>(const var &a, const var &b) { return a.x > b.x; }
+  inline friend constexpr bool operator>=(const var &a, const var &b) { return a.x >= b.x; }
+};
+
+template<typename Float, typename Guard>
+struct is_real<var<Float, Guard>> : std::true_type {};
+
+/**
+ * arena recording the operations on vars, and sweeping them backwards to obtain the derivatives
+ * of one output with respect to every variable at once.
+ * <br/>
+ * Every operation appends a node holding the indices of its operands and its partial derivatives with respect
+ * to them, functions of one argument pointing their second operand at node 0, which stands for all constants.
+ * Nodes are stored in blocks of CQF_AAD_BLOCK that are never moved nor freed before the tape itself,
+ * so that recording does not copy and a rewound tape records again without allocating.
+ * The reverse sweep visits every node once, at two multiply-adds each, which puts the derivatives
+ * of a pricing with respect to all of its inputs at a few times the cost of the pricing.
+ * <br/>
+ * A tape and its vars belong to one thread; vars of different tapes must not be mixed.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename>
+class tape {
+ private:
+  struct tape_node {
+    Float partial[2];      // derivatives with respect to the operands
+    uint32_t operand[2];   // nodes of the operands
+  };
+
+  std::vector<std::unique_ptr<tape_node[]>> blocks;
+  size_t used = 0;
+  std::vector<Float> adjoints;
+
+ public:
+  /**
+   * constructor.
+   */
+  inline
+  tape() {
+    rewind();
+  }
+
+  tape(const tape &) = delete;
+  tape &operator=(const tape &) = delete;
+
+  /**
+   * appends a node, see var::unary and var::binary.
+   *
+   * @param value
+   * @param a first operand
+   * @param da
+   * @param b second operand
+   * @param db
+   * @return var recorded at the new node
+   */
+  inline
+  var<Float>
+  record(Float value, uint32_t a, Float da, uint32_t b, Float db) {
+    if (used == blocks.size() * CQF_AAD_BLOCK) {
+      blocks.emplace_back(new tape_node[CQF_AAD_BLOCK]);
+    }
+    tape_node &n = blocks[used / CQF_AAD_BLOCK][used % CQF_AAD_BLOCK];
+    n.partial[0] = da;
+    n.partial[1] = db;
+    n.operand[0] = a;
+    n.operand[1] = b;
+    return var<Float>(value, static_cast<uint32_t>(used++), this);
+  }
+
+  /**
+   * independent variable, whose derivative is to be read by adjoint.
+   *
+   * @param value
+   * @return
+   */
+  inline
+  var<Float>
+  variable(Float value) {
+    return record(value, 0, 0, 0, 0);
+  }
+
+  /**
+   * forgets every node, keeping the memory for the next recording.
+   * vars recorded so far must not be used anymore.
+   */
+  inline
+  void
+  rewind() {
+    used = 0;
+    record(0, 0, 0, 0, 0);  // node 0, the sink of the derivatives with respect to constants
+  }
+
+  /**
+   * number of nodes recorded.
+   *
+   * @return
+   */
+  inline size_t size() const { return used; }
+
+  /**
+   * reverse sweep: derivatives of y with respect to every var recorded before it.
+   *
+   * @param y
+   */
+  inline
+  void
+  propagate(const var<Float> &y) {
+    adjoints.assign(used, 0);
+    adjoints[y.index()] = 1;
+    for (size_t i = y.index(); i > 0; --i) {
+      const Float adjoint = adjoints[i];
+      const tape_node &n = blocks[i / CQF_AAD_BLOCK][i % CQF_AAD_BLOCK];
+      adjoints[n.operand[0]] += n.partial[0] * adjoint;
+      adjoints[n.operand[1]] += n.partial[1] * adjoint;
+    }
+  }
+
+  /**
+   * derivative of the var last propagated with respect to x, 0 for constants.
+   *
+   * @param x
+   * @return
+   */
+  inline
+  Float
+  adjoint(const var<Float> &x) const {
+    return x.index() == 0 || x.index() >= adjoints.size() ? static_cast<Float>(0) : adjoints[x.index()];
+  }
+};
+
+/**
+ * the functions of this library on vars, recording their derivatives.
+ * they are found by argument dependent lookup from code templated on Float, and preferred
+ * to the generic overloads as more specialized.
+ */
+template<typename Float>
+inline static
+var<Float>
+exp(const var<Float> &x) {
+  const Float value = exp(x.value());
+  return var<Float>::unary(value, x, value);
+}
+
+template<typename Float>
+inline static
+var<Float>
+ln(const var<Float> &x) {
+  return var<Float>::unary(ln(x.value()), x, 1 / x.value());
+}
+
+template<typename Float>
+inline static
+var<Float>
+sqrt(const var<Float> &x) {
+  const Float value = sqrt(x.value());
+  return var<Float>::unary(value, x, static_cast<Float>(0.5) / value);
+}
+
+template<typename Float>
+inline static
+var<Float>
+erf(const var<Float> &x) {
+  return var<Float>::unary(erf(x.value()), x, 2 / constants<Float>::sqrtpi * exp(-x.value() * x.value()));
+}
+
+template<typename Float>
+inline static
+var<Float>
+erfc(const var<Float> &x) {
+  return var<Float>::unary(erfc(x.value()), x, -2 / constants<Float>::sqrtpi * exp(-x.value() * x.value()));
+}
+
+template<typename Float>
+inline static
+var<Float>
+sin(const var<Float> &x) {
+  return var<Float>::unary(sin(x.value()), x, cos(x.value()));
+}
+
+template<typename Float>
+inline static
+var<Float>
+cos(const var<Float> &x) {
+  return var<Float>::unary(cos(x.value()), x, -sin(x.value()));
+}
+
+template<typename Float>
+inline static
+var<Float>
+norm_cdf(const var<Float> &x) {
+  return var<Float>::unary(norm_cdf(x.value()), x, norm_pdf(x.value()));
+}
+
+template<typename Float>
+inline static
+var<Float>
+norm_pdf(const var<Float> &x) {
+  const Float value = norm_pdf(x.value());
+  return var<Float>::unary(value, x, -x.value() * value);
+}
+
+template<typename Float, typename Integral, typename = integral_guard<Integral>>
+inline static
+var<Float>
+power(const var<Float> &x, Integral n) {
+  return var<Float>::unary(power(x.value(), n), x, static_cast<Float>(n) * power(x.value(), n - 1));
+}
+} // namespace cqf
+
+namespace std {
+/**
+ * limits of a var are those of its value.
+ */
+template<typename Float, typename Guard>
+struct numeric_limits<cqf::var<Float, Guard>> : public numeric_limits<Float> {};
+} // namespace std
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_AAD_H_
@@ -267,6 +267,218 @@ common<Numeric, Numerics...>
 prod(Numeric x, Numerics... numerics) {
   return prod(x, prod(numerics...));
 }
+/**
+ * running sum with Neumaier's compensation: the low-order bits lost by every addition are
+ * accumulated separately and added back on reading, so the error stays within a couple of ulps
+ * of the result however many terms are added, instead of growing with their number.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename =floating_guard<Float>>
+struct compensated_sum {
+  Float sum = 0;
+  Float compensation = 0;
+
+  /**
+   * adds a term.
+   *
+   * @param x
+   * @return
+   */
+  inline constexpr
+  compensated_sum &
+  operator+=(Float x) noexcept {
+    const Float t = sum + x;
+    compensation += abs(sum) >= abs(x) ? (sum - t) + x : (x - t) + sum;
+    sum = t;
+    return *this;
+  }
+
+  /**
+   * compensated value of the sum.
+   *
+   * @return
+   */
+  inline constexpr
+  Float
+  value() const noexcept {
+    return sum + compensation;
+  }
+};
+/**
+ * unevaluated sum of two floating point numbers, hi + lo with |lo| <= ulp(hi) / 2,
+ * carrying about twice the precision of Float: 106 bits for doubles, 128 for long doubles.
+ * <br/>
+ * The operations are the error-free transformations two_sum and two_product followed by renormalization,
+ * after Joldes, Muller and Popescu, Tight and rigorous error bounds for basic building blocks of double-word
+ * arithmetic (2017), with relative errors of a few units of Float epsilon squared.
+ * Products split their operands by Veltkamp's method rather than by fused multiply-adds,
+ * which keeps them constant expressions, at the cost of overflowing beyond about limits::max() / 2^(digits / 2).
+ *
+ * @tparam Float
+ */
+template<typename Float, typename =floating_guard<Float>>
+struct double_word {
+  Float hi = 0;
+  Float lo = 0;
+
+  inline constexpr
+  double_word(Float hi = 0, Float lo = 0) noexcept : hi(hi), lo(lo) {}
+
+  /**
+   * value rounded to Float.
+   *
+   * @return
+   */
+  inline constexpr Float value() const noexcept { return hi + lo; }
+
+  /**
+   * exact sum of two numbers, with no condition on their magnitudes.
+   *
+   * @param a
+   * @param b
+   * @return
+   */
+  inline static constexpr
+  double_word
+  two_sum(Float a, Float b) noexcept {
+    const Float s = a + b;
+    const Float b_virtual = s - a;
+    return {s, (a - (s - b_virtual)) + (b - b_virtual)};
+  }
+
+  /**
+   * exact sum of two numbers, provided that |a| >= |b|.
+   *
+   * @param a
+   * @param b
+   * @return
+   */
+  inline static constexpr
+  double_word
+  fast_two_sum(Float a, Float b) noexcept {
+    const Float s = a + b;
+    return {s, b - (s - a)};
+  }
+
+  /**
+   * Veltkamp's splitting of a number into two halves of digits / 2 bits, whose products are exact.
+   * numbers so large that the splitting would overflow are scaled down and back by a power of 2, exactly.
+   *
+   * @param a
+   * @return
+   */
+  inline static constexpr
+  double_word
+  split(Float a) noexcept {
+    constexpr int half = (limits<Float>::digits + 1) / 2;
+    Float factor = 1;
+    for (int i = 0; i < half; ++i) {
+      factor *= 2;
+    }
+    if (abs(a) > limits<Float>::max() / (factor + 1)) {
+      const double_word scaled = split(a / factor);
+      return {scaled.hi * factor, scaled.lo * factor};
+    }
+    const Float c = (factor + 1) * a;
+    const Float high = c - (c - a);
+    return {high, a - high};
+  }
+
+  /**
+   * exact product of two numbers, barring underflow. an overflowing product is infinite, without remainder.
+   *
+   * @param a
+   * @param b
+   * @return
+   */
+  inline static constexpr
+  double_word
+  two_product(Float a, Float b) noexcept {
+    const Float p = a * b;
+    if (!(abs(p) < limits<Float>::infinity())) {
+      return {p, 0};
+    }
+    const double_word x = split(a), y = split(b);
+    return {p, ((x.hi * y.hi - p) + x.hi * y.lo + x.lo * y.hi) + x.lo * y.lo};
+  }
+
+  inline friend constexpr double_word operator-(const double_word &a) { return {-a.hi, -a.lo}; }
+
+  inline friend constexpr double_word operator+(const double_word &a, Float b) {
+    const double_word s = two_sum(a.hi, b);
+    return fast_two_sum(s.hi, a.lo + s.lo);
+  }
+
+  inline friend constexpr double_word operator+(const double_word &a, const double_word &b) {
+    const double_word s = two_sum(a.hi, b.hi), t = two_sum(a.lo, b.lo);
+    const double_word v = fast_two_sum(s.hi, s.lo + t.hi);
+    return fast_two_sum(v.hi, t.lo + v.lo);
+  }
+
+  inline friend constexpr double_word operator-(const double_word &a, Float b) { return a + (-b); }
+
+  inline friend constexpr double_word operator-(const double_word &a, const double_word &b) { return a + (-b); }
+
+  inline friend constexpr double_word operator*(const double_word &a, Float b) {
+    const double_word c = two_product(a.hi, b);
+    const double_word t = fast_two_sum(c.hi, a.lo * b);
+    return fast_two_sum(t.hi, t.lo + c.lo);
+  }
+
+  inline friend constexpr double_word operator*(const double_word &a, const double_word &b) {
+    const double_word c = two_product(a.hi, b.hi);
+    return fast_two_sum(c.hi, c.lo + (a.lo * b.hi + (a.hi * b.lo + a.lo * b.lo)));
+  }
+
+  inline friend constexpr double_word operator/(const double_word &a, Float b) {
+    const Float t = a.hi / b;
+    const double_word p = two_product(t, b);
+    return fast_two_sum(t, (((a.hi - p.hi) - p.lo) + a.lo) / b);
+  }
+
+  inline friend constexpr double_word operator/(const double_word &a, const double_word &b) {
+    const Float t = a.hi / b.hi;
+    const double_word r = b * t;
+    return fast_two_sum(t, ((a.hi - r.hi) + (a.lo - r.lo)) / b.hi);
+  }
+
+  inline constexpr double_word &operator+=(Float b) { return *this = *this + b; }
+};
+
+namespace impl {
+/**
+ * arithmetic in which the terms of the series of exp and erf are computed and accumulated by default:
+ * double words in the high precision mode, unless Float is more precise than long double, as __float128,
+ * which is precise enough by itself while its double words would cost several times as much in software.
+ *
+ * @tparam Float
+ */
+template<typename Float>
+using series = std::conditional_t<CQF_HIGH_PRECISION && limits<Float>::digits <= limits<long double>::digits,
+                                  double_word<Float>, Float>;
+
+/**
+ * value of a series term or sum rounded to Float.
+ *
+ * @tparam Float
+ * @param x
+ * @return
+ */
+template<typename Float>
+inline static constexpr
+Float
+rounded(const double_word<Float> &x) noexcept {
+  return x.value();
+}
+
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+Float
+rounded(Float x) noexcept {
+  return x;
+}
+} // namespace impl
 } // namespace cqf
 
 #endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_BASIC_H_
@@ -4,23 +4,88 @@
 #ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_CONSTANTS_H_
 #define CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_CONSTANTS_H_
 
+#include <type_traits>
+
 #include "traits.h"
 
 namespace cqf {
+namespace impl {
+/**
+ * type in which a constant given as two long doubles is rounded: Numeric itself when more precise than long double.
+ */
+template<typename Numeric>
+using constant_word = std::conditional_t<(limits<Numeric>::digits > limits<long double>::digits), Numeric, long double>;
+
+/**
+ * constant given as the sum of a long double and of its remainder, the remainder mattering only
+ * to types more precise than long double, such as __float128.
+ *
+ * @tparam Numeric
+ * @param high long double literal
+ * @param low constant - high
+ * @return
+ */
+template<typename Numeric>
+inline static constexpr
+Numeric
+extended(long double high, long double low) noexcept {
+  return static_cast<Numeric>(static_cast<constant_word<Numeric>>(high) + static_cast<constant_word<Numeric>>(low));
+}
+
+/**
+ * remainder of a constant after rounding to Numeric, such that rounded + residual holds
+ * twice the precision of Numeric, up to that of the two long doubles.
+ *
+ * @tparam Numeric
+ * @param high long double literal
+ * @param low constant - high
+ * @param rounded constant rounded to Numeric
+ * @return
+ */
+template<typename Numeric>
+inline static constexpr
+Numeric
+residual(long double high, long double low, Numeric rounded) noexcept {
+  using Word = constant_word<Numeric>;
+  return static_cast<Numeric>((static_cast<Word>(high) - static_cast<Word>(rounded)) + static_cast<Word>(low));
+}
+} // namespace impl
+
+/**
+ * mathematical constants, given to about 128 bits as a long double and its remainder.
+ * the *_low members are the remainders after rounding to Numeric, for double-word arithmetic.
+ *
+ * @tparam Numeric
+ */
 template<typename Numeric, typename = floating_guard<Numeric>>
 struct constants {
   inline static constexpr Numeric pi
-      = static_cast<Numeric>(3.14159265358979323846264338327950288419716939937510l);
+      = impl::extended<Numeric>(3.14159265358979323846264338327950288419716939937510l,
+                                -5.016557612668332269423950509954924690974e-20l);
 
   inline static constexpr Numeric e
-      = static_cast<Numeric>(2.71828182845904523536028747135266249775724709369995l);
+      = impl::extended<Numeric>(2.71828182845904523536028747135266249775724709369995l,
+                                -6.788063664127784401459679700643921753206e-20l);
 
   inline static constexpr Numeric sqrt2
-      = static_cast<Numeric>(1.41421356237309504880168872420969807856967187537694l);
+      = impl::extended<Numeric>(1.41421356237309504880168872420969807856967187537694l,
+                                3.790065117786514366717297248640822823410e-20l);
+
+  inline static constexpr Numeric sqrtpi
+      = impl::extended<Numeric>(1.77245385090551602729816748334114518279754945612239l,
+                                -1.277140353282479477708115897880251274310e-20l);
 
   inline static constexpr Numeric _2pi = 2. * pi;
 
   inline static constexpr Numeric _half_pi = 0.5 * pi;
+
+  inline static constexpr Numeric e_low
+      = impl::residual<Numeric>(2.71828182845904523536028747135266249775724709369995l,
+                                -6.788063664127784401459679700643921753206e-20l, e);
+
+  inline static constexpr Numeric sqrtpi_low
+      = impl::residual<Numeric>(1.77245385090551602729816748334114518279754945612239l,
+                                -1.277140353282479477708115897880251274310e-20l, sqrtpi);
 };
 } // namespace cqf
 #endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_CONSTANTS_H_
@@ -0,0 +1,247 @@
+//
+// Created by mamin on 1/1/2021.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_DUAL_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_DUAL_H_
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#include "traits.h"
+#include "basic.h"
+#include "constants.h"
+#include "power.h"
+#include "exp.h"
+#include "log.h"
+#include "sqrt.h"
+#include "erf.h"
+#include "trig.h"
+#include "norm.h"
+
+namespace cqf {
+/**
+ * number carrying its derivatives in N directions, for forward mode algorithmic differentiation.
+ * <br/>
+ * Every operation computes its value and applies the chain rule to the N tangents at once, in a loop of fixed
+ * length the compiler unrolls or vectorizes. Nothing is recorded, so that duals are literal types:
+ * a model templated on Float, such as vanilla or coupon_bond, yields its value and N sensitivities
+ * in a single evaluation, in constant expressions as well as at runtime.
+ * Derivatives with respect to more inputs than directions take several evaluations, see var for reverse mode.
+ *
+ * @tparam Float
+ * @tparam N number of directions
+ */
+template<typename Float, size_t N, typename = floating_guard<Float>>
+class dual {
+ private:
+  Float x;          // value
+  Float dx[N];      // derivatives in every direction
+
+ public:
+  /**
+   * constant, all of its derivatives being 0.
+   *
+   * @param value
+   */
+  inline constexpr
+  dual(Float value = 0) noexcept : x(value), dx{} {}
+
+  /**
+   * constant from any arithmetic value, such that duals of duals, which carry second order derivatives,
+   * mix with literals as well.
+   *
+   * @tparam Arithmetic
+   * @param value
+   */
+  template<typename Arithmetic, typename = std::enable_if_t<std::is_arithmetic_v<Arithmetic>
+                                                               && !std::is_same_v<Arithmetic, Float>>>
+  inline constexpr
+  dual(Arithmetic value) noexcept : dual(static_cast<Float>(value)) {}
+
+  /**
+   * independent variable, whose derivative is 1 in its own direction and 0 in the others.
+   *
+   * @param value
+   * @param direction less than N
+   * @return
+   */
+  inline static constexpr
+  dual
+  variable(Float value, size_t direction) noexcept {
+    dual result(value);
+    result.dx[direction] = 1;
+    return result;
+  }
+
+  inline constexpr Float value() const { return x; }
+
+  /**
+   * derivative in a direction.
+   *
+   * @param direction less than N
+   * @return
+   */
+  inline constexpr Float derivative(size_t direction) const { return dx[direction]; }
+
+  /**
+   * value converted to an arithmetic type, the derivatives being lost.
+   *
+   * @tparam Arithmetic
+   * @return
+   */
+  template<typename Arithmetic, typename = std::enable_if_t<std::is_arithmetic_v<Arithmetic>>>
+  inline explicit constexpr
+  operator Arithmetic() const { return static_cast<Arithmetic>(x); }
+
+  /**
+   * function of one dual, given its derivative.
+   *
+   * @param value
+   * @param a
+   * @param da
+   * @return
+   */
+  inline static constexpr
+  dual
+  unary(Float value, const dual &a, Float da) noexcept {
+    dual result(value);
+    for (size_t i = 0; i < N; ++i) {
+      result.dx[i] = da * a.dx[i];
+    }
+    return result;
+  }
+
+  /**
+   * function of two duals, given its partial derivatives.
+   *
+   * @param value
+   * @param a
+   * @param da
+   * @param b
+   * @param db
+   * @return
+   */
+  inline static constexpr
+  dual
+  binary(Float value, const dual &a, Float da, const dual &b, Float db) noexcept {
+    dual result(value);
+    for (size_t i = 0; i < N; ++i) {
+      result.dx[i] = da * a.dx[i] + db * b.dx[i];
+    }
+    return result;
+  }
+
+  inline friend constexpr dual operator+(const dual &a) { return a; }
+  inline friend constexpr dual operator-(const dual &a) { return unary(-a.x, a, -1); }
+  inline friend constexpr dual operator+(const dual &a, const dual &b) { return binary(a.x + b.x, a, 1, b, 1); }
+  inline friend constexpr dual operator-(const dual &a, const dual &b) { return binary(a.x - b.x, a, 1, b, -1); }
+  inline friend constexpr dual operator*(const dual &a, const dual &b) { return binary(a.x * b.x, a, b.x, b, a.x); }
+  inline friend constexpr dual operator/(const dual &a, const dual &b) {
+    const Float value = a.x / b.x;
+    return binary(value, a, 1 / b.x, b, -value / b.x);
+  }
+
+  inline constexpr dual &operator+=(const dual &b) { return *this = *this + b; }
+  inline constexpr dual &operator-=(const dual &b) { return *this = *this - b; }
+  inline constexpr dual &operator*=(const dual &b) { return *this = *this * b; }
+  inline constexpr dual &operator/=(const dual &b) { return *this = *this / b; }
+
+  inline friend constexpr bool operator==(const dual &a, const dual &b) { return a.x == b.x; }
+  inline friend constexpr bool operator!=(const dual &a, const dual &b) { return a.x != b.x; }
+  inline friend constexpr bool operator<(const dual &a, const dual &b) { return a.x < b.x; }
+  inline friend constexpr bool operator<=(const dual &a, const dual &b) { return a.x <= b.x; }
+  inline friend constexpr bool operator>(const dual &a, const dual &b) { return a.x > b.x; }
+  inline friend constexpr bool operator>=(const dual &a, const dual &b) { return a.x >= b.x; }
+};
+
+template<typename Float, size_t N, typename Guard>
+struct is_real<dual<Float, N, Guard>> : std::true_type {};
+
+/**
+ * the functions of this library on duals, evaluated by their Float counterparts,
+ * at compile time in constant expressions.
+ */
+template<typename Float, size_t N>
+inline static constexpr
+dual<Float, N>
+exp(const dual<Float, N> &x) noexcept {
+  const Float value = exp(x.value());
+  return dual<Float, N>::unary(value, x, value);
+}
+
+template<typename Float, size_t N>
+inline static constexpr
+dual<Float, N>
+ln(const dual<Float, N> &x) noexcept {
+  return dual<Float, N>::unary(ln(x.value()), x, 1 / x.value());
+}
+
+template<typename Float, size_t N>
+inline static constexpr
+dual<Float, N>
+sqrt(const dual<Float, N> &x) noexcept {
+  const Float value = sqrt(x.value());
+  return dual<Float, N>::unary(value, x, static_cast<Float>(0.5) / value);
+}
+
+template<typename Float, size_t N>
+inline static constexpr
+dual<Float, N>
+erf(const dual<Float, N> &x) noexcept {
+  return dual<Float, N>::unary(erf(x.value()), x, 2 / constants<Float>::sqrtpi * exp(-x.value() * x.value()));
+}
+
+template<typename Float, size_t N>
+inline static constexpr
+dual<Float, N>
+erfc(const dual<Float, N> &x) noexcept {
+  return dual<Float, N>::unary(erfc(x.value()), x, -2 / constants<Float>::sqrtpi * exp(-x.value() * x.value()));
+}
+
+template<typename Float, size_t N>
+inline static constexpr
+dual<Float, N>
+sin(const dual<Float, N> &x) noexcept {
+  return dual<Float, N>::unary(sin(x.value()), x, cos(x.value()));
+}
+
+template<typename Float, size_t N>
+inline static constexpr
+dual<Float, N>
+cos(const dual<Float, N> &x) noexcept {
+  return dual<Float, N>::unary(cos(x.value()), x, -sin(x.value()));
+}
+
+template<typename Float, size_t N>
+inline static constexpr
+dual<Float, N>
+norm_cdf(const dual<Float, N> &x) noexcept {
+  return dual<Float, N>::unary(norm_cdf(x.value()), x, norm_pdf(x.value()));
+}
+
+template<typename Float, size_t N>
+inline static constexpr
+dual<Float, N>
+norm_pdf(const dual<Float, N> &x) noexcept {
+  const Float value = norm_pdf(x.value());
+  return dual<Float, N>::unary(value, x, -x.value() * value);
+}
+
+template<typename Float, size_t N, typename Integral, typename = integral_guard<Integral>>
+inline static constexpr
+dual<Float, N>
+power(const dual<Float, N> &x, Integral n) noexcept {
+  return dual<Float, N>::unary(power(x.value(), n), x, static_cast<Float>(n) * power(x.value(), n - 1));
+}
+} // namespace cqf
+
+namespace std {
+/**
+ * limits of a dual are those of its value.
+ */
+template<typename Float, size_t N, typename Guard>
+struct numeric_limits<cqf::dual<Float, N, Guard>> : public numeric_limits<Float> {};
+} // namespace std
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_DUAL_H_
@@ -0,0 +1,252 @@
+//
+// Created by mamin on 12/22/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_GAUSS_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_GAUSS_H_
+
+#include <array>
+#include <cstddef>
+
+#include "traits.h"
+#include "basic.h"
+#include "constants.h"
+#include "exp.h"
+#include "log.h"
+#include "sqrt.h"
+#include "trig.h"
+
+namespace cqf {
+namespace impl {
+/**
+ * nodes in ascending order and weights of an N-point Gaussian quadrature rule.
+ *
+ * @tparam Float
+ * @tparam N
+ */
+template<typename Float, size_t N, typename = floating_guard<Float>>
+struct gauss_rule {
+  std::array<Float, N> nodes;
+  std::array<Float, N> weights;
+};
+
+/**
+ * whether a Newton step on a root of an orthogonal polynomial has converged,
+ * in absolute terms near the origin, where the middle root of odd rules lies.
+ *
+ * @tparam Float
+ * @param z
+ * @param dz
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+bool
+gauss_converged(Float z, Float dz) noexcept {
+  return abs(dz) <= CQF_GAUSS_ERROR_SCALE * limits<Float>::epsilon() * max(abs(z), static_cast<Float>(1));
+}
+
+/**
+ * Gauss-Legendre rule on [-1, 1], weight 1.
+ * every root of P_N is polished by Newton's method from the asymptotic guess cos(pi (i + 3/4) / (N + 1/2)),
+ * P_N and P_N' coming from the three-term recurrence (k + 1) P_{k+1} = (2k + 1) x P_k - k P_{k-1}.
+ *
+ * @tparam Float
+ * @tparam N
+ * @return
+ */
+template<typename Float, size_t N, typename = floating_guard<Float>>
+inline static constexpr
+gauss_rule<Float, N>
+gauss_legendre_rule() noexcept {
+  gauss_rule<Float, N> rule{};
+  for (size_t i = 0; i < (N + 1) / 2; ++i) {
+    Float z = cos(constants<Float>::pi * (static_cast<Float>(i) + static_cast<Float>(0.75)) / (N + static_cast<Float>(0.5)));
+    Float dp = 0;
+    for (size_t iteration = 0; iteration < CQF_GAUSS_MAX_ITERATIONS; ++iteration) {
+      Float p0 = 1, p1 = 0;
+      for (size_t k = 0; k < N; ++k) {
+        const Float p2 = p1;
+        p1 = p0;
+        p0 = ((2 * k + 1) * z * p1 - k * p2) / (k + 1);
+      }
+      dp = N * (z * p0 - p1) / (z * z - 1);
+      const Float dz = p0 / dp;
+      z -= dz;
+      if (gauss_converged(z, dz)) {
+        break;
+      }
+    }
+    // the middle root of odd rules is exactly 0
+    z = 2 * i + 1 == N ? static_cast<Float>(0) : z;
+    rule.nodes[i] = -z;
+    rule.nodes[N - 1 - i] = z;
+    rule.weights[i] = rule.weights[N - 1 - i] = 2 / ((1 - z * z) * dp * dp);
+  }
+  return rule;
+}
+
+/**
+ * Gauss-Laguerre rule on [0, inf), weight e^(-x).
+ * the roots of L_N are polished by Newton's method from the guesses of Numerical Recipes' gaulag,
+ * each extrapolated from the previous two, L_N and L_N' coming from the recurrence
+ * (k + 1) L_{k+1} = (2k + 1 - x) L_k - k L_{k-1}.
+ *
+ * @tparam Float
+ * @tparam N
+ * @return
+ */
+template<typename Float, size_t N, typename = floating_guard<Float>>
+inline static constexpr
+gauss_rule<Float, N>
+gauss_laguerre_rule() noexcept {
+  gauss_rule<Float, N> rule{};
+  Float z = 0;
+  for (size_t i = 0; i < N; ++i) {
+    if (i == 0) {
+      z = 3 / (1 + static_cast<Float>(2.4) * N);
+    } else if (i == 1) {
+      z += 15 / (1 + static_cast<Float>(2.5) * N);
+    } else {
+      const Float ai = static_cast<Float>(i - 1);
+      z += (1 + static_cast<Float>(2.55) * ai) / (static_cast<Float>(1.9) * ai) * (z - rule.nodes[i - 2]);
+    }
+    Float dp = 0, previous = 0;
+    for (size_t iteration = 0; iteration < CQF_GAUSS_MAX_ITERATIONS; ++iteration) {
+      Float p0 = 1, p1 = 0;
+      for (size_t k = 0; k < N; ++k) {
+        const Float p2 = p1;
+        p1 = p0;
+        p0 = ((2 * k + 1 - z) * p1 - k * p2) / (k + 1);
+      }
+      dp = N * (p0 - p1) / z;
+      previous = p1;
+      const Float dz = p0 / dp;
+      z -= dz;
+      if (gauss_converged(z, dz)) {
+        break;
+      }
+    }
+    rule.nodes[i] = z;
+    rule.weights[i] = -1 / (dp * N * previous);
+  }
+  return rule;
+}
+
+/**
+ * Gauss-Hermite rule on (-inf, inf), weight e^(-x^2).
+ * the roots are polished by Newton's method from the guesses of Numerical Recipes' gauher, largest first,
+ * on the orthonormal Hermite functions, whose recurrence
+ * p_{k+1} = x sqrt(2 / (k + 1)) p_k - sqrt(k / (k + 1)) p_{k-1}
+ * neither overflows nor underflows for the rule sizes of interest.
+ *
+ * @tparam Float
+ * @tparam N
+ * @return
+ */
+template<typename Float, size_t N, typename = floating_guard<Float>>
+inline static constexpr
+gauss_rule<Float, N>
+gauss_hermite_rule() noexcept {
+  // coefficients of the recurrence, computed once rather than per Newton step
+  std::array<Float, N> a{}, b{};
+  for (size_t k = 0; k < N; ++k) {
+    a[k] = sqrt(static_cast<Float>(2) / (k + 1));
+    b[k] = sqrt(static_cast<Float>(k) / (k + 1));
+  }
+  const Float p_init = 1 / sqrt(sqrt(constants<Float>::pi));
+  const Float two_n = sqrt(static_cast<Float>(2 * N));
+
+  gauss_rule<Float, N> rule{};
+  Float z = 0;
+  for (size_t i = 0; i < (N + 1) / 2; ++i) {
+    if (i == 0) {
+      z = sqrt(static_cast<Float>(2 * N + 1))
+          - static_cast<Float>(1.85575) * exp(-static_cast<Float>(0.16667) * ln(static_cast<Float>(2 * N + 1)));
+    } else if (i == 1) {
+      z -= static_cast<Float>(1.14) * exp(static_cast<Float>(0.426) * ln(static_cast<Float>(N))) / z;
+    } else if (i == 2) {
+      z = static_cast<Float>(1.86) * z - static_cast<Float>(0.86) * rule.nodes[N - 1];
+    } else if (i == 3) {
+      z = static_cast<Float>(1.91) * z - static_cast<Float>(0.91) * rule.nodes[N - 2];
+    } else {
+      z = 2 * z - rule.nodes[N - 1 - (i - 2)];
+    }
+    Float dp = 0;
+    for (size_t iteration = 0; iteration < CQF_GAUSS_MAX_ITERATIONS; ++iteration) {
+      Float p0 = p_init, p1 = 0;
+      for (size_t k = 0; k < N; ++k) {
+        const Float p2 = p1;
+        p1 = p0;
+        p0 = z * a[k] * p1 - b[k] * p2;
+      }
+      dp = two_n * p1;
+      const Float dz = p0 / dp;
+      z -= dz;
+      if (gauss_converged(z, dz)) {
+        break;
+      }
+    }
+    z = 2 * i + 1 == N ? static_cast<Float>(0) : z;
+    rule.nodes[i] = -z;
+    rule.nodes[N - 1 - i] = z;
+    rule.weights[i] = rule.weights[N - 1 - i] = 2 / (dp * dp);
+  }
+  return rule;
+}
+} // namespace impl
+
+/**
+ * N-point Gauss-Legendre nodes and weights on [-1, 1], generated at compile time.
+ * exact for polynomials of degree up to 2N - 1.
+ *
+ * @tparam Float
+ * @tparam N
+ */
+template<typename Float, size_t N, typename = floating_guard<Float>>
+struct gauss_legendre {
+  inline static constexpr size_t size = N;
+
+  inline static constexpr impl::gauss_rule<Float, N> rule = impl::gauss_legendre_rule<Float, N>();
+
+  inline static constexpr std::array<Float, N> nodes = rule.nodes;
+
+  inline static constexpr std::array<Float, N> weights = rule.weights;
+};
+
+/**
+ * N-point Gauss-Laguerre nodes and weights for integrals of f(x) e^(-x) over [0, inf), generated at compile time.
+ *
+ * @tparam Float
+ * @tparam N
+ */
+template<typename Float, size_t N, typename = floating_guard<Float>>
+struct gauss_laguerre {
+  inline static constexpr size_t size = N;
+
+  inline static constexpr impl::gauss_rule<Float, N> rule = impl::gauss_laguerre_rule<Float, N>();
+
+  inline static constexpr std::array<Float, N> nodes = rule.nodes;
+
+  inline static constexpr std::array<Float, N> weights = rule.weights;
+};
+
+/**
+ * N-point Gauss-Hermite nodes and weights for integrals of f(x) e^(-x^2) over the real line,
+ * generated at compile time.
+ *
+ * @tparam Float
+ * @tparam N
+ */
+template<typename Float, size_t N, typename = floating_guard<Float>>
+struct gauss_hermite {
+  inline static constexpr size_t size = N;
+
+  inline static constexpr impl::gauss_rule<Float, N> rule = impl::gauss_hermite_rule<Float, N>();
+
+  inline static constexpr std::array<Float, N> nodes = rule.nodes;
+
+  inline static constexpr std::array<Float, N> weights = rule.weights;
+};
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_GAUSS_H_
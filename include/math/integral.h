@@ -4,28 +4,97 @@
 #ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_INTEGRAL_H_
 #define CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_INTEGRAL_H_
 
+#include <array>
+#include <cstddef>
+
 #include "traits.h"
+#include "basic.h"
+#include "constants.h"
+#include "gauss.h"
 
 namespace cqf {
 
 namespace impl {
 /**
- * incrementally adds function terms.
+ * evaluates an integrand at a single point, whether it is a plain function of one variable or a batch_func.
+ *
+ * @tparam Float
+ * @tparam Func any callable as Float(Float), or as void(const Float *, Float *, size_t)
+ * @param func
+ * @param x
+ * @return
+ */
+template<typename Float, typename Func, typename =floating_guard<Float>>
+inline static constexpr
+Float
+evaluate(const Func &func, Float x) {
+  if constexpr (batch_func<Func, Float>) {
+    Float y = 0;
+    func(&x, &y, 1);
+    return y;
+  } else {
+    return func(x);
+  }
+}
+
+/**
+ * evaluates an integrand at n abscissae, in a single call if it is a batch_func.
+ *
+ * @tparam Float
+ * @tparam Func
+ * @param func
+ * @param x abscissae
+ * @param y output values
+ * @param n
+ */
+template<typename Float, typename Func, typename =floating_guard<Float>>
+inline static constexpr
+void
+evaluate(const Func &func, const Float *x, Float *y, size_t n) {
+  if constexpr (batch_func<Func, Float>) {
+    func(x, y, n);
+  } else {
+    for (size_t i = 0; i < n; ++i) {
+      y[i] = func(x[i]);
+    }
+  }
+}
+
+/**
+ * adds the function terms at cur, cur + step, ... up to end, to a starting value.
+ * the abscissae are computed from their index rather than by repeated increments, so they do not drift,
+ * are handed to the integrand CQF_INTEGRAL_BLOCK at a time, and the terms are accumulated in double-word arithmetic,
+ * each by an error-free two_sum, so that the sum is exact to about twice the precision of Float.
  *
  * @tparam Float
  * @param func function-like
- * @param acc result accumulator
- * @param cur current term
+ * @param acc starting value
+ * @param cur first abscissa
  * @param step increment in independent variable
  * @param end stopping endpoint
  * @return
  */
-template<typename Float, typename =floating_guard<Float>>
+template<typename Float, typename Func, typename =floating_guard<Float>>
 inline static constexpr
 Float
-integrate_sum(const univariate_real_func<Float> &func, Float acc, Float cur, Float step, Float end) {
-  return cur > end ? acc :
-         integrate_sum(func, acc + func(cur), cur + step, step, end);
+integrate_sum(const Func &func, Float acc, Float cur, Float step, Float end) {
+  if (cur > end) {
+    return acc;
+  }
+  const size_t n = static_cast<size_t>((end - cur) / step) + 1;
+  double_word<Float> result(acc);
+  Float x[CQF_INTEGRAL_BLOCK] = {}, y[CQF_INTEGRAL_BLOCK] = {};
+  for (size_t begin = 0; begin < n; begin += CQF_INTEGRAL_BLOCK) {
+    const size_t size = min(n - begin, static_cast<size_t>(CQF_INTEGRAL_BLOCK));
+    for (size_t i = 0; i < size; ++i) {
+      x[i] = cur + static_cast<Float>(begin + i) * step;
+    }
+    evaluate(func, x, y, size);
+    for (size_t i = 0; i < size; ++i) {
+      result += y[i];
+    }
+  }
+  return result.value();
 }
 
 /**
@@ -38,14 +107,14 @@ integrate_sum(const univariate_real_func<Float> &func, Float acc, Float cur, Flo
  * @param step size of partitions
  * @return
  */
-template<typename Float, typename =floating_guard<Float>>
+template<typename Float, typename Func, typename =floating_guard<Float>>
 inline static constexpr
 Float
-integrate_impl(const univariate_real_func<Float> &func, Float a, Float b, Float step) {
+integrate_impl(const Func &func, Float a, Float b, Float step) {
   return
       step / 3. *
           (
-              sum(func(a), func(b), // terminal
+              sum(evaluate(func, a), evaluate(func, b), // terminal
                   integrate_sum(func, static_cast<Float>(0), a + step, step * 2, b) * 4., // midpoints
                   integrate_sum(func, static_cast<Float>(0), a + 2 * step, 2 * step, b - step) * 2. // endpoints
               )
@@ -62,52 +131,487 @@ integrate_impl(const univariate_real_func<Float> &func, Float a, Float b, Float
  * @param n
  * @return
  */
-template<typename Float, typename =floating_guard<Float>>
+template<typename Float, typename Func, typename =floating_guard<Float>>
 inline static constexpr
 Float
-integrate_part(const univariate_real_func<Float> &func, Float a, Float b, size_t n) {
+integrate_part(const Func &func, Float a, Float b, size_t n) {
   return impl::integrate_impl(func, a, b, (b - a) / n);
 }
 
 /**
- * recursively approximates the function integral by using finer and finer partitions.
+ * approximates the function integral by using finer and finer partitions,
+ * until two successive estimates agree or the partition reaches CQF_MAXIMUM_SIMPSON_PARTITION.
  *
  * @tparam Float
  * @param func
  * @param a
  * @param b
- * @param cur
- * @param prev
- * @param n
+ * @param cur current estimate
+ * @param prev previous estimate
+ * @param n current number of partitions
  * @return
  */
-template<typename Float, typename =floating_guard<Float>>
+template<typename Float, typename Func, typename =floating_guard<Float>>
 inline static constexpr
 Float
-integrate_recur(const univariate_real_func<Float> &func, Float a, Float b, Float cur, Float prev, size_t n) {
-  return (
-             /*acceptable error rate*/ abs(cur - prev) < limits<Float>::epsilon() * abs(cur) &&
-          /*at least 16 partitions
-           *2 iterations to get rid of the initial two guesses*/  n > CQF_MINIMUM_SIMPSON_PARTITION
-         ) /*maximum partitions*/ || (n > CQF_MAXIMUM_SIMPSON_PARTITION) ? cur :
-         /*double partition numbers*/ integrate_recur(func, a, b, integrate_part(func, a, b, n * 2), cur, n * 2);
+integrate_recur(const Func &func, Float a, Float b, Float cur, Float prev, size_t n) {
+  while (/*acceptable error rate*/ !(abs(cur - prev) < limits<Float>::epsilon() * abs(cur) &&
+         /*at least 16 partitions
+          *2 iterations to get rid of the initial two guesses*/ n > CQF_MINIMUM_SIMPSON_PARTITION) &&
+         /*maximum partitions*/ n <= CQF_MAXIMUM_SIMPSON_PARTITION) {
+    /*double partition numbers*/
+    prev = cur;
+    n *= 2;
+    cur = integrate_part(func, a, b, n);
+  }
+  return cur;
+}
+
+} // namespace impl
+
+/**
+ * value of an integral along with an estimate of its absolute error and the number of integrand evaluations.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct integral_result {
+  Float value;
+  Float error;
+  size_t evaluations;
+};
+
+namespace impl {
+/**
+ * one level of adaptive Simpson's rule over [a, b], given the integrand at a, (a + b) / 2 and b
+ * and Simpson's estimate over the whole interval.
+ * only the two quarter points are evaluated, the halves being refined only if
+ * they disagree with the whole by more than 15 times the tolerance, in which case their difference,
+ * the leading error term, is added back as Richardson extrapolation.
+ *
+ * @tparam Float
+ * @param func
+ * @param a
+ * @param b
+ * @param fa
+ * @param fm
+ * @param fb
+ * @param whole
+ * @param tolerance absolute tolerance over [a, b]
+ * @param depth remaining levels of bisection
+ * @return
+ */
+template<typename Float, typename Func, typename =floating_guard<Float>>
+inline static constexpr
+integral_result<Float>
+integrate_simpson_recur(const Func &func, Float a, Float b, Float fa, Float fm, Float fb,
+                        Float whole, Float tolerance, size_t depth) {
+  const Float m = (a + b) / 2;
+  const Float x[2] = {(a + m) / 2, (m + b) / 2};
+  Float f[2] = {0, 0};
+  evaluate(func, x, f, 2);
+  const Float flm = f[0], frm = f[1];
+  const Float left = (m - a) / 6 * (fa + 4 * flm + fm);
+  const Float right = (b - m) / 6 * (fm + 4 * frm + fb);
+  const Float delta = left + right - whole;
+  if (depth == 0 || abs(delta) <= 15 * tolerance) {
+    return {left + right + delta / 15, abs(delta) / 15, 2};
+  }
+  const integral_result<Float> l = integrate_simpson_recur(func, a, m, fa, flm, fm, left, tolerance / 2, depth - 1);
+  const integral_result<Float> r = integrate_simpson_recur(func, m, b, fm, frm, fb, right, tolerance / 2, depth - 1);
+  return {l.value + r.value, l.error + r.error, l.evaluations + r.evaluations + 2};
+}
+
+/**
+ * an interval of the adaptive Gauss-Kronrod integrator with its estimate and error.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct kronrod_interval {
+  Float a, b, value, error;
+};
+
+/**
+ * positive nodes and weights of the 15-point Gauss-Kronrod rule on [-1, 1].
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct kronrod_weights {
+  std::array<Float, 7> nodes;    // descending, the Gauss nodes at odd indices
+  std::array<Float, 8> kronrod;  // Kronrod weights of the nodes, and of the center last
+  std::array<Float, 4> gauss;    // Gauss weights of nodes[1], nodes[3], nodes[5], and of the center last
+};
+
+/**
+ * 15-point Gauss-Kronrod rule on [-1, 1], generated in Float rather than read off double literals.
+ * <br/>
+ * The 7 Gauss nodes are those of gauss_legendre_rule. The 8 Kronrod nodes are the roots of the monic
+ * Stieltjes polynomial E(x) = x^8 + e3 x^6 + e2 x^4 + e1 x^2 + e0, orthogonal to x, x^3, x^5 and x^7
+ * with the weight P_7: as the moments m_k of x^k P_7 vanish below k = 7, the conditions form a triangular system
+ * in m_7, m_9, ..., m_15. They are polished by Newton's method from the midpoints between the Gauss nodes.
+ * As the rule is exact up to degree 22, integrating E P_7 / (x - x_i) gives the weights m_7 / (P_7 E')
+ * at the Kronrod nodes and w_i + m_7 / (P_7' E) at the Gauss nodes, w_i being their Gauss weights.
+ *
+ * @tparam Float
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+kronrod_weights<Float>
+kronrod_legendre_rule() noexcept {
+  using word = double_word<Float>;
+  constexpr size_t N = 7;
+  const gauss_rule<Float, N> gauss = gauss_legendre_rule<Float, N>();
+
+  // m_{N + 2k} = 2^(N + 1) (N + 2k)! (N + k)! / (k! (2N + 2k + 1)!), m_N = 2 N! / (2N + 1)!!, each from the previous one
+  word m[N + 1] = {};
+  m[0] = 2;
+  for (size_t k = 1; k <= N; ++k) {
+    m[0] = m[0] * static_cast<Float>(k) / static_cast<Float>(2 * k + 1);
+  }
+  for (size_t k = 0; k < N; ++k) {
+    m[k + 1] = m[k] * static_cast<Float>((N + 2 * k + 2) * (N + 2 * k + 1) * (N + k + 1))
+        / static_cast<Float>((k + 1) * (2 * N + 2 * k + 3) * (2 * N + 2 * k + 2));
+  }
+  word e[5] = {0, 0, 0, 0, 1};
+  for (size_t i = 0; i < 4; ++i) {
+    word sum = 0;
+    for (size_t j = 4 - i; j <= 4; ++j) {
+      sum = sum + e[j] * m[j + i - 3];
+    }
+    e[3 - i] = -sum / m[0];
+  }
+  // E and E' in double words: the terms of E are of order 1 about its roots, and would cost them tens of ulps in Float
+  const auto stieltjes = [&e](Float x, Float &de) {
+    const word y = word::two_product(x, x);
+    de = rounded(((((e[4] * static_cast<Float>(4)) * y + e[3] * static_cast<Float>(3)) * y
+        + e[2] * static_cast<Float>(2)) * y + e[1]) * (2 * x));
+    return rounded((((e[4] * y + e[3]) * y + e[2]) * y + e[1]) * y + e[0]);
+  };
+  const auto legendre = [](Float x, Float &dp) {
+    Float p0 = 1, p1 = 0;
+    for (size_t k = 0; k < N; ++k) {
+      const Float p2 = p1;
+      p1 = p0;
+      p0 = ((2 * k + 1) * x * p1 - k * p2) / (k + 1);
+    }
+    dp = x == 0 ? N * p1 : N * (x * p0 - p1) / ((x - 1) * (x + 1));
+    return p0;
+  };
+  const Float moment = rounded(m[0]);
+
+  kronrod_weights<Float> rule{};
+  for (size_t i = 0; i < 4; ++i) {
+    const Float outer = i == 0 ? static_cast<Float>(1) : gauss.nodes[N - i];
+    Float z = (outer + gauss.nodes[N - 1 - i]) / 2, de = 0;
+    for (size_t iteration = 0; iteration < CQF_GAUSS_MAX_ITERATIONS; ++iteration) {
+      const Float dz = stieltjes(z, de) / de;
+      z -= dz;
+      if (gauss_converged(z, dz)) {
+        break;
+      }
+    }
+    stieltjes(z, de);
+    Float dp = 0;
+    rule.nodes[2 * i] = z;
+    rule.kronrod[2 * i] = moment / (legendre(z, dp) * de);
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    const Float z = gauss.nodes[N - 1 - i];
+    Float dp = 0, de = 0;
+    legendre(z, dp);
+    rule.gauss[i] = 2 / ((1 - z) * (1 + z) * dp * dp);
+    const Float w = rule.gauss[i] + moment / (dp * stieltjes(z, de));
+    if (i < 3) {
+      rule.nodes[2 * i + 1] = z;
+      rule.kronrod[2 * i + 1] = w;
+    } else {
+      rule.kronrod[7] = w;
+    }
+  }
+  return rule;
+}
+
+/**
+ * the 15-point Gauss-Kronrod rule in Float, generated once at compile time.
+ *
+ * @tparam Float
+ */
+template<typename Float>
+inline constexpr kronrod_weights<Float> kronrod_legendre = kronrod_legendre_rule<Float>();
+
+/**
+ * abscissae of the 15-point Kronrod rule over [a, b], Gauss-Kronrod nodes first mirrored to the left,
+ * then to the right of the center, and the center last.
+ *
+ * @tparam Float
+ * @param a
+ * @param b
+ * @param x output, 15 abscissae
+ */
+template<typename Float, typename =floating_guard<Float>>
+inline static constexpr
+void
+kronrod_nodes(Float a, Float b, Float *x) noexcept {
+  const Float center = (a + b) / 2, half = (b - a) / 2;
+  for (size_t i = 0; i < 7; ++i) {
+    x[i] = center - half * kronrod_legendre<Float>.nodes[i];
+    x[7 + i] = center + half * kronrod_legendre<Float>.nodes[i];
+  }
+  x[14] = center;
+}
+
+/**
+ * 15-point Kronrod rule over [a, b] given the integrand at kronrod_nodes,
+ * its error estimated by the difference to the embedded 7-point Gauss rule.
+ *
+ * @tparam Float
+ * @param a
+ * @param b
+ * @param f integrand values at the 15 abscissae of kronrod_nodes
+ * @return
+ */
+template<typename Float, typename =floating_guard<Float>>
+inline static constexpr
+kronrod_interval<Float>
+kronrod_rule(Float a, Float b, const Float *f) noexcept {
+  const std::array<Float, 8> &wk = kronrod_legendre<Float>.kronrod;
+  const std::array<Float, 4> &wg = kronrod_legendre<Float>.gauss;
+
+  const Float half = (b - a) / 2;
+  Float kronrod = wk[7] * f[14], gauss = wg[3] * f[14];
+  for (size_t i = 0; i < 7; ++i) {
+    const Float pair = f[i] + f[7 + i];
+    kronrod += wk[i] * pair;
+    if (i % 2 == 1) {
+      gauss += wg[i / 2] * pair;
+    }
+  }
+  return {a, b, kronrod * half, abs((kronrod - gauss) * half)};
 }
 
+/**
+ * 15-point Kronrod rule over [a, b], the integrand being evaluated at all abscissae in a single batch.
+ *
+ * @tparam Float
+ * @param func
+ * @param a
+ * @param b
+ * @return
+ */
+template<typename Float, typename Func, typename =floating_guard<Float>>
+inline static constexpr
+kronrod_interval<Float>
+kronrod15(const Func &func, Float a, Float b) {
+  Float x[15] = {}, f[15] = {};
+  kronrod_nodes(a, b, x);
+  evaluate(func, x, f, 15);
+  return kronrod_rule(a, b, f);
+}
 } // namespace impl
 
+/**
+ * integrates a real-valued function by adaptive Simpson's rule.
+ * <br/>
+ * Every bisection reuses the three values of its parent and evaluates the integrand at two new points,
+ * so only subintervals whose estimate has not settled cost further evaluations.
+ * The starting five points must resolve the shape of the integrand well enough for a feature not to be missed.
+ *
+ * @tparam Float
+ * @param func
+ * @param a left endpoint
+ * @param b right endpoint
+ * @param tolerance relative to the first estimate of the integral
+ * @return value, error estimate and number of evaluations
+ */
+template<typename Float, typename Func, typename =floating_guard<Float>>
+inline static constexpr
+integral_result<Float>
+integrate_simpson(const Func &func, Float a, Float b,
+                  Float tolerance = CQF_INTEGRAL_TOLERANCE) {
+  const Float x[3] = {a, (a + b) / 2, b};
+  Float f[3] = {0, 0, 0};
+  impl::evaluate(func, x, f, 3);
+  const Float fa = f[0], fm = f[1], fb = f[2];
+  const Float whole = (b - a) / 6 * (fa + 4 * fm + fb);
+  const Float scale = whole == 0 ? static_cast<Float>(1) : abs(whole);
+  integral_result<Float> result =
+      impl::integrate_simpson_recur(func, a, b, fa, fm, fb, whole, tolerance * scale, CQF_MAXIMUM_SIMPSON_DEPTH);
+  result.evaluations += 3;
+  return result;
+}
+
+/**
+ * integrates a real-valued function by globally adaptive Gauss-Kronrod 7-15 quadrature.
+ * <br/>
+ * The interval with the largest error estimate is bisected until the total error estimate drops below
+ * the tolerance relative to the integral, or CQF_MAXIMUM_KRONROD_INTERVALS intervals are in use.
+ * Smooth integrands typically settle on the very first 15 points.
+ *
+ * @tparam Float
+ * @param func
+ * @param a left endpoint
+ * @param b right endpoint
+ * @param tolerance relative
+ * @return value, error estimate and number of evaluations
+ */
+template<typename Float, typename Func, typename =floating_guard<Float>>
+inline static constexpr
+integral_result<Float>
+integrate_kronrod(const Func &func, Float a, Float b,
+                  Float tolerance = CQF_INTEGRAL_TOLERANCE) {
+  std::array<impl::kronrod_interval<Float>, CQF_MAXIMUM_KRONROD_INTERVALS> intervals{};
+  intervals[0] = impl::kronrod15(func, a, b);
+  size_t n = 1;
+  Float value = intervals[0].value, error = intervals[0].error;
+  while (error > tolerance * abs(value) && n < CQF_MAXIMUM_KRONROD_INTERVALS) {
+    size_t worst = 0;
+    for (size_t i = 1; i < n; ++i) {
+      worst = intervals[i].error > intervals[worst].error ? i : worst;
+    }
+    // both halves in one batch of 30 abscissae
+    const Float l = intervals[worst].a, r = intervals[worst].b, m = (l + r) / 2;
+    Float x[30] = {}, f[30] = {};
+    impl::kronrod_nodes(l, m, x);
+    impl::kronrod_nodes(m, r, x + 15);
+    impl::evaluate(func, x, f, 30);
+    intervals[worst] = impl::kronrod_rule(l, m, f);
+    intervals[n++] = impl::kronrod_rule(m, r, f + 15);
+    value = error = 0;
+    for (size_t i = 0; i < n; ++i) {
+      value += intervals[i].value;
+      error += intervals[i].error;
+    }
+  }
+  return {value, error, 15 * (2 * n - 1)};
+}
+
 /**
  * integrate a real-valued function over an interval
+ * by adaptive Gauss-Kronrod quadrature, see integrate_kronrod.
+ * <br/>
+ * The integrand is taken by its own type, so that a lambda or functor is inlined into the rule
+ * and, if constexpr, may be integrated at compile time.
+ * A batch_func, callable as func(const Float *x, Float *y, size_t n), receives all abscissae
+ * of a rule at once and may evaluate them with the kernels of simd.h.
  *
  * @tparam Float
+ * @tparam Func any callable as Float(Float), or a batch_func
  * @param func function-like
  * @param a left endpoint
  * @param b right endpoint
  * @return
  */
-template<typename Float, typename =floating_guard<Float>>
+template<typename Float, typename Func, typename =floating_guard<Float>>
 inline static constexpr
-Float integrate(const univariate_real_func<Float> &func, Float a, Float b) {
-  return impl::integrate_recur(func, a, b, 1., 0., /*initial 4 partitions*/4);
+Float integrate(const Func &func, Float a, Float b) {
+  return integrate_kronrod(func, a, b).value;
+}
+
+/**
+ * integrate a real-valued function over an interval by composite Simpson's rule,
+ * doubling a uniform partition until two successive estimates agree.
+ * every doubling evaluates the whole partition again, prefer integrate for anything but reference values.
+ *
+ * @tparam Float
+ * @param func function-like
+ * @param a left endpoint
+ * @param b right endpoint
+ * @return
+ */
+template<typename Float, typename Func, typename =floating_guard<Float>>
+inline static constexpr
+Float integrate_uniform(const Func &func, Float a, Float b) {
+  return impl::integrate_recur(func, a, b, static_cast<Float>(1), static_cast<Float>(0), /*initial 4 partitions*/4);
+}
+/**
+ * applies a Gaussian quadrature rule, sum of w_i f(x_i), handing all nodes to the integrand at once.
+ *
+ * @tparam Rule gauss_legendre, gauss_laguerre or gauss_hermite
+ * @tparam Func
+ * @param func
+ * @return
+ */
+template<typename Rule, typename Func>
+inline static constexpr
+auto
+integrate_gauss(const Func &func) {
+  using Float = typename decltype(Rule::nodes)::value_type;
+  std::array<Float, Rule::size> f{};
+  impl::evaluate(func, Rule::nodes.data(), f.data(), Rule::size);
+  Float result = 0;
+  for (size_t i = 0; i < Rule::size; ++i) {
+    result += Rule::weights[i] * f[i];
+  }
+  return result;
+}
+
+/**
+ * integrate a real-valued function over an interval by N-point Gauss-Legendre quadrature,
+ * whose nodes and weights are generated at compile time.
+ * <br/>
+ * Exact for polynomials of degree up to 2N - 1, and converging geometrically for functions analytic
+ * around [a, b], it costs exactly N evaluations, with neither error estimate nor adaptivity.
+ *
+ * @tparam N number of nodes
+ * @tparam Float
+ * @tparam Func
+ * @param func
+ * @param a left endpoint
+ * @param b right endpoint
+ * @return
+ */
+template<size_t N = CQF_GAUSS_NODES, typename Float, typename Func, typename =floating_guard<Float>>
+inline static constexpr
+Float
+integrate_gauss(const Func &func, Float a, Float b) {
+  using rule = gauss_legendre<Float, N>;
+  const Float center = (a + b) / 2, half = (b - a) / 2;
+  std::array<Float, N> x{}, f{};
+  for (size_t i = 0; i < N; ++i) {
+    x[i] = center + half * rule::nodes[i];
+  }
+  impl::evaluate(func, x.data(), f.data(), N);
+  Float result = 0;
+  for (size_t i = 0; i < N; ++i) {
+    result += rule::weights[i] * f[i];
+  }
+  return result * half;
+}
+
+/**
+ * expectation of f(X) for a normal X ~ N(mu, sigma^2) by N-point Gauss-Hermite quadrature,
+ * E[f(X)] = sum of w_i f(mu + sqrt(2) sigma x_i) / sqrt(pi).
+ * <br/>
+ * Smooth payoffs against a normal density typically settle with 20 to 60 nodes,
+ * where composite rules would need thousands; kinks, such as max(x - K, 0), converge only algebraically
+ * and are better split at the kink and integrated by integrate_kronrod.
+ *
+ * @tparam N number of nodes
+ * @tparam Float
+ * @tparam Func
+ * @param func
+ * @param mu mean
+ * @param sigma standard deviation
+ * @return
+ */
+template<size_t N = CQF_GAUSS_NODES, typename Float, typename Func, typename =floating_guard<Float>>
+inline static constexpr
+Float
+integrate_gauss_normal(const Func &func, Float mu, Float sigma) {
+  using rule = gauss_hermite<Float, N>;
+  std::array<Float, N> x{}, f{};
+  for (size_t i = 0; i < N; ++i) {
+    x[i] = mu + constants<Float>::sqrt2 * sigma * rule::nodes[i];
+  }
+  impl::evaluate(func, x.data(), f.data(), N);
+  Float result = 0;
+  for (size_t i = 0; i < N; ++i) {
+    result += rule::weights[i] * f[i];
+  }
+  return result / constants<Float>::sqrtpi;
 }
 } // namespace cqf
 
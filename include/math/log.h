@@ -51,12 +51,32 @@ ln_impl(Float x) noexcept {
          ln_reduce(x);
 
 }
+
+/**
+ * logarithm at runtime of a type more precise than long double, such as __float128:
+ * the long double logarithm is refined by one step of the iteration of ln_recur, which triples its digits.
+ *
+ * @tparam Float
+ * @param x
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static
+Float
+ln_extended(Float x) noexcept {
+  if (!(x > 0 && x < limits<Float>::infinity())) {
+    return ln_impl(x);
+  }
+  const Float l0 = static_cast<Float>(std::log(static_cast<long double>(x)));
+  return l0 + static_cast<Float>(2.) * (x - exp(l0)) / (x + exp(l0));
+}
 } // namespace impl
 /**
  * Natural logarithm, i.e. logarithm with Euler number as base
  * <br/>
  * A compromise has been made here for preciser answer for x's near 1,
- * but the method cannot compute extremely large or small answers due to its use of the exponential
+ * but the method cannot compute extremely large or small answers due to its use of the exponential.
+ * Runtime evaluations defer to std::log, for the types it supports, and start from it for the others.
  *
  * @tparam Numeric
  * @param x
@@ -66,13 +86,19 @@ template<typename Numeric>
 inline static constexpr
 promoted<Numeric>
 ln(Numeric x) noexcept {
-#if CQF_CONSTEXPR_STL_FALLBACK
-  return std::log(static_cast<promoted<Numeric>>(x));
-#else
-  return x == static_cast<Numeric>(2) ? static_cast<promoted<Numeric>>(0.6931471805599453094172321214581765680755l) :
-         x == static_cast<Numeric>(10) ? static_cast<promoted<Numeric>>(2.3025850929940456840179914546843642076011l) :
-         impl::ln_impl(static_cast<promoted<Numeric>>(x));
-#endif
+  if constexpr (!std_math<promoted<Numeric>>) {
+    if (CQF_CONSTANT_EVALUATED()) {
+      return impl::ln_impl(static_cast<promoted<Numeric>>(x));
+    }
+    return impl::ln_extended(static_cast<promoted<Numeric>>(x));
+  } else {
+    if (CQF_CONSTANT_EVALUATED()) {
+      return x == static_cast<Numeric>(2) ? static_cast<promoted<Numeric>>(0.6931471805599453094172321214581765680755l) :
+             x == static_cast<Numeric>(10) ? static_cast<promoted<Numeric>>(2.3025850929940456840179914546843642076011l) :
+             impl::ln_impl(static_cast<promoted<Numeric>>(x));
+    }
+    return std::log(static_cast<promoted<Numeric>>(x));
+  }
 }
 
 /**
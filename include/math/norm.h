@@ -5,7 +5,11 @@
 #define CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_NORM_H_
 
 #include "traits.h"
+#include "basic.h"
+#include "constants.h"
 #include "erf.h"
+#include "exp.h"
+#include "log.h"
 #include "sqrt.h"
 
 namespace cqf {
@@ -13,7 +17,7 @@ template<typename Numeric>
 inline static constexpr
 promoted<Numeric>
 norm_cdf(Numeric x) noexcept {
-  return 0.5 * (1. + erf(x / constants < promoted < Numeric >> ::sqrt2));
+  return 0.5 * erfc(-x / constants < promoted < Numeric >> ::sqrt2);
 } // func norm_cdf
 
 template<typename Numeric>
@@ -22,6 +26,116 @@ promoted<Numeric>
 norm_pdf(Numeric x) noexcept {
   return 1. / sqrt(constants < promoted < Numeric >> ::_2pi) * exp(-0.5 * x * x);
 } // func norm_pdf
+
+namespace impl {
+/**
+ * central region |p - 0.5| <= 0.425 of Wichura's AS241 (PPND16), a rational function of degree 7 in 0.180625 - q^2.
+ *
+ * @tparam Float
+ * @param q p - 0.5
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+Float
+norm_ppf_central(Float q) noexcept {
+  const Float r = static_cast<Float>(0.180625) - q * q;
+  return q * (((((((2.5090809287301226727e+3 * r + 3.3430575583588128105e+4) * r
+      + 6.7265770927008700853e+4) * r + 4.5921953931549871457e+4) * r + 1.3731693765509461125e+4) * r
+      + 1.9715909503065514427e+3) * r + 1.3314166789178437745e+2) * r + 3.3871328727963666080e+0)
+      / (((((((5.2264952788528545610e+3 * r + 2.8729085735721942674e+4) * r + 3.9307895800092710610e+4) * r
+          + 2.1213794301586595867e+4) * r + 5.3941960214247511077e+3) * r + 6.8718700749205790830e+2) * r
+          + 4.2313330701600911252e+1) * r + 1);
+}
+
+/**
+ * tails of Wichura's AS241 (PPND16), rational functions of degree 7 in r = sqrt(-ln p) for the smaller tail p.
+ *
+ * @tparam Float
+ * @param r sqrt(-ln p), at least 1.6
+ * @return the magnitude of the quantile
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+Float
+norm_ppf_tail(Float r) noexcept {
+  if (r <= 5) {
+    r -= static_cast<Float>(1.6);
+    return (((((((7.74545014278341407640e-4 * r + 2.27238449892691845833e-2) * r
+        + 2.41780725177450611770e-1) * r + 1.27045825245236838258e+0) * r + 3.64784832476320460504e+0) * r
+        + 5.76949722146069140550e+0) * r + 4.63033784615654529590e+0) * r + 1.42343711074968357734e+0)
+        / (((((((1.05075007164441684324e-9 * r + 5.47593808499534494600e-4) * r + 1.51986665636164571966e-2) * r
+            + 1.48103976427480074590e-1) * r + 6.89767334985100004550e-1) * r + 1.67638483018380384940e+0) * r
+            + 2.05319162663775882187e+0) * r + 1);
+  }
+  r -= 5;
+  return (((((((2.01033439929228813265e-7 * r + 2.71155556874348757815e-5) * r
+      + 1.24266094738807843860e-3) * r + 2.65321895265761230930e-2) * r + 2.96560571828504891230e-1) * r
+      + 1.78482653991729133580e+0) * r + 5.46378491116411436990e+0) * r + 6.65790464350110377720e+0)
+      / (((((((2.04426310338993978564e-15 * r + 1.42151175831644588870e-7) * r + 1.84631831751005468180e-5) * r
+          + 7.86869131145613259100e-4) * r + 1.48753612908506148525e-2) * r + 1.36929880922735805310e-1) * r
+          + 5.99832206555887937690e-1) * r + 1);
+}
+
+/**
+ * one Halley step towards the root of norm_cdf(x) - p.
+ *
+ * @tparam Float
+ * @param x
+ * @param p
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+Float
+norm_ppf_halley(Float x, Float p) noexcept {
+  const Float u = (norm_cdf(x) - p) * sqrt(constants<Float>::_2pi) * exp(x * x / 2);
+  return x - u / (1 + x * u / 2);
+}
+} // namespace impl
+
+/**
+ * inverse of the standard normal distribution, the quantile function.
+ * Wichura's AS241 (PPND16), relative error about 1e-16.
+ * the tails are evaluated in terms of the smaller of p and 1 - p,
+ * so quantiles close to 1 are limited by how accurately 1 - p is represented, not by the approximation.
+ *
+ * @tparam Numeric
+ * @param p probability
+ * @return x such that norm_cdf(x) = p, -inf at 0, inf at 1, nan outside [0, 1]
+ */
+template<typename Numeric>
+inline static constexpr
+promoted<Numeric>
+norm_ppf(Numeric p) noexcept {
+  using Float = promoted<Numeric>;
+  const auto u = static_cast<Float>(p);
+  const Float q = u - static_cast<Float>(0.5);
+  return nan(u) or u < 0 or u > 1 ? limits<Float>::quiet_NaN() :
+         u == 0 ? -limits<Float>::infinity() :
+         u == 1 ? limits<Float>::infinity() :
+         abs(q) <= static_cast<Float>(0.425) ? impl::norm_ppf_central(q) :
+         q < 0 ? -impl::norm_ppf_tail(sqrt(-ln(u))) :
+         impl::norm_ppf_tail(sqrt(-ln(1 - u)));
+} // func norm_ppf
+
+/**
+ * inverse of the standard normal distribution, refined by one Halley step on norm_cdf.
+ * AS241 is already accurate to double precision,
+ * the refinement is for types wider than double, where it roughly triples the number of correct digits.
+ *
+ * @tparam Numeric
+ * @param p probability
+ * @return
+ */
+template<typename Numeric>
+inline static constexpr
+promoted<Numeric>
+norm_ppf_refined(Numeric p) noexcept {
+  using Float = promoted<Numeric>;
+  const Float x = norm_ppf(p);
+  return finite(x) and not nan(x) ? impl::norm_ppf_halley(x, static_cast<Float>(p)) : x;
+} // func norm_ppf_refined
 } // namespace cqf
 
 #endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_NORM_H_
@@ -0,0 +1,122 @@
+//
+// Created by mamin on 12/23/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_PHILOX_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_PHILOX_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "traits.h"
+#include "basic.h"
+#include "constants.h"
+#include "trig.h"
+#include "simd.h"
+
+namespace cqf {
+/**
+ * Philox4x32-10 counter-based random number generator (Salmon et al., Random123).
+ * <br/>
+ * The output is a pure function of a 128 bit counter and a 64 bit key, there is no state to advance.
+ * Parallel streams are thus obtained by simply giving every stream its own counters,
+ * and any draw of any stream can be reproduced on its own, regardless of how work is split across threads.
+ */
+class philox {
+ public:
+  using counter_type = std::array<uint32_t, 4>;
+
+ private:
+  uint32_t k0, k1;
+
+  inline static constexpr uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+  inline static constexpr uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+ public:
+  /**
+   * constructor.
+   *
+   * @param seed key of the generator
+   */
+  inline explicit constexpr
+  philox(uint64_t seed) noexcept
+      : k0(static_cast<uint32_t>(seed)), k1(static_cast<uint32_t>(seed >> 32)) {}
+
+  /**
+   * 128 random bits for a counter.
+   *
+   * @param c
+   * @return
+   */
+  inline constexpr
+  counter_type
+  operator()(counter_type c) const noexcept {
+    uint32_t key0 = k0, key1 = k1;
+    for (size_t round = 0; round < 10; ++round) {
+      const uint64_t p0 = static_cast<uint64_t>(M0) * c[0];
+      const uint64_t p1 = static_cast<uint64_t>(M1) * c[2];
+      c = {static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ key0, static_cast<uint32_t>(p1),
+           static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ key1, static_cast<uint32_t>(p0)};
+      key0 += W0;
+      key1 += W1;
+    }
+    return c;
+  }
+};
+
+namespace impl {
+/**
+ * uniform double in the open interval (0, 1) from 64 random bits, keeping the upper 53.
+ *
+ * @param hi
+ * @param lo
+ * @return
+ */
+inline static constexpr
+double
+uniform(uint32_t hi, uint32_t lo) noexcept {
+  return (static_cast<double>(((static_cast<uint64_t>(hi) << 32 | lo) >> 11)) + 0.5)
+      / static_cast<double>(uint64_t{1} << 53);
+}
+} // namespace impl
+
+/**
+ * fills z with n standard normal draws of the given stream, by the Box-Muller transform.
+ * <br/>
+ * Draws 2j and 2j + 1 come from the counter (j, stream, stream >> 32, 0),
+ * the radii of a whole block are computed by the vectorized ln and sqrt kernels of simd.h.
+ *
+ * @param rng
+ * @param stream
+ * @param z
+ * @param n
+ */
+inline static
+void
+normal_fill(const philox &rng, uint64_t stream, double *z, size_t n) noexcept {
+  double radius[CQF_SIMD_BLOCK / 2], angle[CQF_SIMD_BLOCK / 2];
+  for (size_t begin = 0; begin < n; begin += CQF_SIMD_BLOCK) {
+    const size_t m = min(static_cast<size_t>(CQF_SIMD_BLOCK), n - begin);
+    const size_t pairs = (m + 1) / 2;
+    for (size_t j = 0; j < pairs; ++j) {
+      const auto bits = rng({static_cast<uint32_t>(begin / 2 + j), static_cast<uint32_t>(stream),
+                             static_cast<uint32_t>(stream >> 32), 0});
+      radius[j] = impl::uniform(bits[0], bits[1]);
+      angle[j] = constants<double>::_2pi * impl::uniform(bits[2], bits[3]);
+    }
+    simd::ln(radius, radius, pairs);
+    for (size_t j = 0; j < pairs; ++j) {
+      radius[j] *= -2.;
+    }
+    simd::sqrt(radius, radius, pairs);
+    for (size_t j = 0; j < pairs; ++j) {
+      z[begin + 2 * j] = radius[j] * cos(angle[j]);
+      if (2 * j + 1 < m) {
+        z[begin + 2 * j + 1] = radius[j] * sin(angle[j]);
+      }
+    }
+  }
+}
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_PHILOX_H_
@@ -0,0 +1,741 @@
+//
+// Created by mamin on 12/19/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_SIMD_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_SIMD_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CQF_SIMD_X86 1
+#else
+#define CQF_SIMD_X86 0
+#endif
+
+#include "traits.h"
+
+/**
+ * every vector kernel must be inlined into its caller.
+ * the kernels are compiled for whatever instruction set the caller is compiled for,
+ * and an out-of-line vector function would be called with a mismatching calling convention
+ * whenever the caller and the callee disagree on the instruction set.
+ */
+#define CQF_SIMD_INLINE inline __attribute__((always_inline))
+
+/**
+ * number of elements batch routines chaining several array kernels process at a time,
+ * small enough for all intermediate arrays of a block to stay in L1 cache.
+ */
+#define CQF_SIMD_BLOCK 256
+
+/**
+ * width in bytes of the widest vector registers of the instruction set the translation unit is compiled for,
+ * for loops written on batches rather than dispatched at runtime.
+ */
+#if defined(__AVX512F__)
+#define CQF_SIMD_BYTES 64
+#elif defined(__AVX__)
+#define CQF_SIMD_BYTES 32
+#else
+#define CQF_SIMD_BYTES 16
+#endif
+
+namespace cqf {
+/**
+ * runtime kernels operating on several doubles at once.
+ * <br/>
+ * The scalar functions in cqf are constexpr and serve as the compile-time reference,
+ * whereas these kernels are meant for bulk evaluation at runtime.
+ * They use range reduction followed by minimax polynomial / rational approximations
+ * (the fdlibm coefficients) and are accurate to about one unit in the last place.
+ * <br/>
+ * Two interfaces are provided:
+ * overloads on batch<double, N> (2, 4 or 8 lanes, interchangeable with __m128d / __m256d / __m512d),
+ * compiled for the instruction set of the calling translation unit, and
+ * array entry points (exp, ln, sqrt, erf, erfc, norm_ppf over pointers) dispatching at runtime to SSE2, AVX2 or AVX-512.
+ */
+namespace simd {
+template<typename Numeric, size_t N>
+struct vector_of {
+  typedef Numeric type __attribute__((vector_size(N * sizeof(Numeric))));
+};
+
+/**
+ * N lanes of Numeric held in one vector register.
+ */
+template<typename Numeric, size_t N>
+using batch = typename vector_of<Numeric, N>::type;
+
+/**
+ * instruction sets the array entry points dispatch to.
+ */
+enum class isa { sse2, avx2, avx512 };
+
+namespace impl {
+/**
+ * integer vector of the same shape as V, which is also the type of lane-wise comparisons.
+ */
+template<typename V>
+using mask_of = decltype(V{} < V{});
+
+template<typename V>
+CQF_SIMD_INLINE
+V splat(double x) noexcept {
+  return V{} + x;
+}
+
+template<typename V>
+CQF_SIMD_INLINE
+mask_of<V> as_int(V x) noexcept {
+  return (mask_of<V>) x;
+}
+
+template<typename V, typename M>
+CQF_SIMD_INLINE
+V as_float(M x) noexcept {
+  return (V) x;
+}
+
+/**
+ * whether any lane of a comparison holds.
+ */
+template<typename M>
+CQF_SIMD_INLINE
+bool any(M mask) noexcept {
+  bool result = false;
+  for (size_t i = 0; i < sizeof(M) / sizeof(mask[0]); ++i) {
+    result |= mask[i] != 0;
+  }
+  return result;
+}
+
+/**
+ * evaluates c0 + c1 x + c2 x^2 + ... using Horner's scheme.
+ */
+template<typename V>
+CQF_SIMD_INLINE
+V horner(V, double c) noexcept {
+  return splat<V>(c);
+}
+
+template<typename V, typename... Coefficients>
+CQF_SIMD_INLINE
+V horner(V x, double c, Coefficients... cs) noexcept {
+  return c + x * horner(x, cs...);
+}
+
+/**
+ * exp(x).
+ * reduces x = k ln2 + r with |r| <= ln2 / 2,
+ * approximates exp(r) with the fdlibm Remez rational form and scales by 2^k.
+ *
+ * @tparam V
+ * @param x
+ * @return
+ */
+template<typename V>
+CQF_SIMD_INLINE
+V exp_batch(V x) noexcept {
+  using M = mask_of<V>;
+  constexpr double o_threshold = 7.09782712893383973096e+02;
+  constexpr double u_threshold = -7.45133219101941108420e+02;
+  constexpr double ln2_hi = 6.93147180369123816490e-01;
+  constexpr double ln2_lo = 1.90821492927058770002e-10;
+  constexpr double log2e = 1.44269504088896338700e+00;
+  constexpr double shifter = 6755399441055744.0;      // 1.5 * 2^52, rounds to nearest integer when added
+
+  V xc = x > o_threshold ? splat<V>(o_threshold) : x;
+  xc = xc < u_threshold ? splat<V>(u_threshold) : xc;
+
+  const V t = xc * log2e + shifter;
+  const V kd = t - shifter;
+  const M k = as_int(t) - as_int(splat<V>(shifter));
+
+  const V hi = xc - kd * ln2_hi;
+  const V lo = kd * ln2_lo;
+  const V r = hi - lo;
+  const V rr = r * r;
+  const V c = r - rr * horner(rr,
+                              1.66666666666666019037e-01,
+                              -2.77777777770155933842e-03,
+                              6.61375632143793436117e-05,
+                              -1.65339022054652515390e-06,
+                              4.13813679705723846039e-08);
+  V y = 1. - ((lo - (r * c) / (2. - c)) - hi);
+
+  // scale in two steps so that subnormal results are not flushed to zero
+  const M k1 = k >> 1;
+  const M k2 = k - k1;
+  y = y * as_float<V>((k1 + 1023) << 52) * as_float<V>((k2 + 1023) << 52);
+
+  y = x > o_threshold ? splat<V>(limits<double>::infinity()) : y;
+  y = x < u_threshold ? splat<V>(0.) : y;
+  return x != x ? x : y;
+}
+
+/**
+ * natural logarithm.
+ * splits x = 2^k (1 + f) with sqrt(2) / 2 <= 1 + f < sqrt(2)
+ * and approximates ln(1 + f) with the fdlibm Remez polynomial in s = f / (2 + f).
+ *
+ * @tparam V
+ * @param x
+ * @return
+ */
+template<typename V>
+CQF_SIMD_INLINE
+V ln_batch(V x) noexcept {
+  using M = mask_of<V>;
+  constexpr double ln2_hi = 6.93147180369123816490e-01;
+  constexpr double ln2_lo = 1.90821492927058770002e-10;
+  constexpr double two52 = 4503599627370496.0;
+  constexpr double two54 = 18014398509481984.0;
+
+  // subnormal inputs are brought into the normal range first
+  const M subnormal = (x < limits<double>::min()) & (x > 0.);
+  const V xs = subnormal ? x * two54 : x;
+  const M hx = as_int(xs);
+
+  const M exponent = (hx >> 52) & 0x7ff;
+  V y = as_float<V>((hx & 0x000fffffffffffffL) | 0x3ff0000000000000L);  // mantissa in [1, 2)
+  const M big = y > 1.41421356237309504880;
+  y = big ? y * 0.5 : y;
+
+  V k = as_float<V>(exponent | as_int(splat<V>(two52))) - two52 - 1023.;
+  k = big ? k + 1. : k;
+  k = subnormal ? k - 54. : k;
+
+  const V f = y - 1.;
+  const V s = f / (2. + f);
+  const V z = s * s;
+  const V w = z * z;
+  const V t1 = w * horner(w, 3.999999999940941908e-01, 2.222219843214978396e-01, 1.531383769920937332e-01);
+  const V t2 = z * horner(w, 6.666666666666735130e-01, 2.857142874366239149e-01,
+                          1.818357216161805012e-01, 1.479819860511658591e-01);
+  const V R = t2 + t1;
+  const V hfsq = 0.5 * f * f;
+  V result = k * ln2_hi - ((hfsq - (s * (hfsq + R) + k * ln2_lo)) - f);
+
+  result = x == limits<double>::infinity() ? x : result;
+  result = x == 0. ? splat<V>(-limits<double>::infinity()) : result;
+  result = x < 0. ? splat<V>(limits<double>::quiet_NaN()) : result;
+  return x != x ? x : result;
+}
+
+/**
+ * erf(x) / x - 1 for |x| < 0.84375, the fdlibm rational approximation in x^2.
+ *
+ * @tparam V
+ * @param zz x^2
+ * @return
+ */
+template<typename V>
+CQF_SIMD_INLINE
+V erf_small(V zz) noexcept {
+  return horner(zz, 1.28379167095512558561e-01, -3.25042107247001499370e-01,
+                -2.84817495755985104766e-02, -5.77027029648944159157e-03,
+                -2.37630166566501626084e-05)
+      / horner(zz, 1., 3.97917223959155352819e-01, 6.50222499887672944485e-02,
+               5.08130628187576562776e-03, 1.32494738004321644526e-04,
+               -3.96022827877536812320e-06);
+}
+
+/**
+ * erf(|x|) - erx for 0.84375 <= |x| < 1.25, erx = 0.845062911510467529297 being erf(1) rounded to 30 bits,
+ * the fdlibm rational approximation in |x| - 1.
+ *
+ * @tparam V
+ * @param s |x| - 1
+ * @return
+ */
+template<typename V>
+CQF_SIMD_INLINE
+V erf_medium(V s) noexcept {
+  return horner(s, -2.36211856075265944077e-03, 4.14856118683748331666e-01, -3.72207876035701323847e-01,
+                3.18346619901161753674e-01, -1.10894694282396677476e-01, 3.54783043256182359371e-02,
+                -2.16637559486879084300e-03)
+      / horner(s, 1., 1.06420880400844228286e-01, 5.40397917702171048937e-01, 7.18286544141962662868e-02,
+               1.26171219808761642112e-01, 1.36370839120290507362e-02, 1.19844998467991074170e-02);
+}
+
+/**
+ * erfc(|x|) for 1.25 <= |x|, exp(-x^2 - 0.5625 + R / S) / |x| with the fdlibm rational approximations
+ * on [1.25, 1 / 0.35) and [1 / 0.35, 28), and 0 from 28 on, where it underflows.
+ *
+ * @tparam V
+ * @param ax |x|
+ * @return
+ */
+template<typename V>
+CQF_SIMD_INLINE
+V erfc_tail(V ax) noexcept {
+  const V u = 1. / (ax * ax);
+  const V R = ax < 1. / 0.35
+              ? horner(u, -9.86494403484714822705e-03, -6.93858572707181764372e-01, -1.05586262253232909814e+01,
+                       -6.23753324503260060396e+01, -1.62396669462573470355e+02, -1.84605092906711035994e+02,
+                       -8.12874355063065934246e+01, -9.81432934416914548592e+00)
+              : horner(u, -9.86494292470009928597e-03, -7.99283237680523006574e-01, -1.77579549177547519889e+01,
+                       -1.60636384855821916062e+02, -6.37566443368389627722e+02, -1.02509513161107724954e+03,
+                       -4.83519191608651397019e+02);
+  const V S = ax < 1. / 0.35
+              ? horner(u, 1., 1.96512716674392571292e+01, 1.37657754143519042600e+02, 4.34565877475229228821e+02,
+                       6.45387271733267880336e+02, 4.29008140027567833386e+02, 1.08635005541779435134e+02,
+                       6.57024977031928170135e+00, -6.04244152148580987438e-02)
+              : horner(u, 1., 3.03380607434824582924e+01, 3.25792512996573918826e+02, 1.53672958608443695994e+03,
+                       3.19985821950859553908e+03, 2.55305040643316442583e+03, 4.74528541206955367215e+02,
+                       -2.24409524465858183362e+01);
+  const V z = as_float<V>(as_int(ax) & static_cast<int64_t>(0xffffffff00000000ULL));  // |x| with low word cleared
+  const V tail = exp_batch(-z * z - 0.5625) * exp_batch((z - ax) * (z + ax) + R / S) / ax;
+  return ax < 28. ? tail : splat<V>(0.);
+}
+
+/**
+ * error function.
+ * evaluates the four fdlibm rational approximations on [0, 0.84375), [0.84375, 1.25), [1.25, 1 / 0.35), [1 / 0.35, 6)
+ * and blends the lanes, erf being 1 to double precision beyond 6.
+ *
+ * @tparam V
+ * @param x
+ * @return
+ */
+template<typename V>
+CQF_SIMD_INLINE
+V erf_batch(V x) noexcept {
+  constexpr double erx = 8.45062911510467529297e-01;
+  const V ax = x < 0. ? -x : x;
+  const V small = x + x * erf_small(x * x);
+  const V medium = erx + erf_medium(ax - 1.);
+  const V large = 1. - erfc_tail(ax);
+
+  V result = ax < 6. ? large : splat<V>(1.);
+  result = ax < 1.25 ? medium : result;
+  result = x < 0. ? -result : result;
+  result = ax < 0.84375 ? small : result;
+  return x != x ? x : result;
+}
+
+/**
+ * complementary error function, over the same fdlibm approximations as erf_batch.
+ * the right tail is evaluated directly, without the cancellation of 1 - erf(x), down to the underflow near 27.
+ *
+ * @tparam V
+ * @param x
+ * @return
+ */
+template<typename V>
+CQF_SIMD_INLINE
+V erfc_batch(V x) noexcept {
+  constexpr double erx = 8.45062911510467529297e-01;
+  const V ax = x < 0. ? -x : x;
+  const V y = x * erf_small(x * x);
+  const V small = x < 0.25 ? 1. - (x + y) : 0.5 - (y + (x - 0.5));
+  const V P = erf_medium(ax - 1.);
+  const V medium = x < 0. ? 1. + (erx + P) : (1. - erx) - P;
+  const V tail = erfc_tail(ax);
+
+  V result = x < 0. ? 2. - tail : tail;
+  result = ax < 1.25 ? medium : result;
+  result = ax < 0.84375 ? small : result;
+  return x != x ? x : result;
+}
+
+/**
+ * square root, lane by lane.
+ * the overloads in namespace simd replace this with the hardware instruction wherever available.
+ *
+ * @tparam V
+ * @param x
+ * @return
+ */
+template<typename V>
+CQF_SIMD_INLINE
+V sqrt_batch(V x) noexcept {
+  V result = x;
+  for (size_t i = 0; i < sizeof(V) / sizeof(double); ++i) {
+    result[i] = __builtin_sqrt(x[i]);
+  }
+  return result;
+}
+} // namespace impl
+
+/**
+ * exp(x) lane by lane.
+ *
+ * @param x
+ * @return
+ */
+CQF_SIMD_INLINE batch<double, 2> exp(batch<double, 2> x) noexcept { return impl::exp_batch(x); }
+CQF_SIMD_INLINE batch<double, 4> exp(batch<double, 4> x) noexcept { return impl::exp_batch(x); }
+CQF_SIMD_INLINE batch<double, 8> exp(batch<double, 8> x) noexcept { return impl::exp_batch(x); }
+
+/**
+ * ln(x) lane by lane.
+ *
+ * @param x
+ * @return
+ */
+CQF_SIMD_INLINE batch<double, 2> ln(batch<double, 2> x) noexcept { return impl::ln_batch(x); }
+CQF_SIMD_INLINE batch<double, 4> ln(batch<double, 4> x) noexcept { return impl::ln_batch(x); }
+CQF_SIMD_INLINE batch<double, 8> ln(batch<double, 8> x) noexcept { return impl::ln_batch(x); }
+
+/**
+ * erf(x) lane by lane.
+ *
+ * @param x
+ * @return
+ */
+CQF_SIMD_INLINE batch<double, 2> erf(batch<double, 2> x) noexcept { return impl::erf_batch(x); }
+CQF_SIMD_INLINE batch<double, 4> erf(batch<double, 4> x) noexcept { return impl::erf_batch(x); }
+CQF_SIMD_INLINE batch<double, 8> erf(batch<double, 8> x) noexcept { return impl::erf_batch(x); }
+
+/**
+ * erfc(x) lane by lane.
+ *
+ * @param x
+ * @return
+ */
+CQF_SIMD_INLINE batch<double, 2> erfc(batch<double, 2> x) noexcept { return impl::erfc_batch(x); }
+CQF_SIMD_INLINE batch<double, 4> erfc(batch<double, 4> x) noexcept { return impl::erfc_batch(x); }
+CQF_SIMD_INLINE batch<double, 8> erfc(batch<double, 8> x) noexcept { return impl::erfc_batch(x); }
+
+/**
+ * sqrt(x) lane by lane.
+ *
+ * @param x
+ * @return
+ */
+CQF_SIMD_INLINE
+batch<double, 2> sqrt(batch<double, 2> x) noexcept {
+#if CQF_SIMD_X86 && defined(__SSE2__)
+  return _mm_sqrt_pd(x);
+#else
+  return impl::sqrt_batch(x);
+#endif
+}
+
+CQF_SIMD_INLINE
+batch<double, 4> sqrt(batch<double, 4> x) noexcept {
+#if CQF_SIMD_X86 && defined(__AVX__)
+  return _mm256_sqrt_pd(x);
+#else
+  return impl::sqrt_batch(x);
+#endif
+}
+
+CQF_SIMD_INLINE
+batch<double, 8> sqrt(batch<double, 8> x) noexcept {
+#if CQF_SIMD_X86 && defined(__AVX512F__)
+  return _mm512_mask_sqrt_pd(_mm512_setzero_pd(), 0xFF, x);  // see apply_avx512<sqrt_kernel>
+#else
+  return impl::sqrt_batch(x);
+#endif
+}
+
+namespace impl {
+/**
+ * inverse of the standard normal distribution.
+ * evaluates the central rational function of AS241 and, only if some lane lies in a tail,
+ * the tail rational functions in the square root of ln of the smaller of p and 1 - p, blending the lanes.
+ *
+ * @tparam V
+ * @param p
+ * @return
+ */
+template<typename V>
+CQF_SIMD_INLINE
+V norm_ppf_batch(V p) noexcept {
+  const V q = p - 0.5;
+  const V rc = 0.180625 - q * q;
+  const V central = q * horner(rc, 3.3871328727963666080e+0, 1.3314166789178437745e+2, 1.9715909503065514427e+3,
+                               1.3731693765509461125e+4, 4.5921953931549871457e+4, 6.7265770927008700853e+4,
+                               3.3430575583588128105e+4, 2.5090809287301226727e+3)
+      / horner(rc, 1., 4.2313330701600911252e+1, 6.8718700749205790830e+2, 5.3941960214247511077e+3,
+               2.1213794301586595867e+4, 3.9307895800092710610e+4, 2.8729085735721942674e+4,
+               5.2264952788528545610e+3);
+
+  V result = central;
+  const auto tails = (q > 0.425) | (q < -0.425);
+  if (any(tails)) {
+    const V r = simd::sqrt(-ln_batch(q < 0. ? p : 1. - p));
+    const V rn = r - 1.6;
+    V tail = horner(rn, 1.42343711074968357734e+0, 4.63033784615654529590e+0, 5.76949722146069140550e+0,
+                    3.64784832476320460504e+0, 1.27045825245236838258e+0, 2.41780725177450611770e-1,
+                    2.27238449892691845833e-2, 7.74545014278341407640e-4)
+        / horner(rn, 1., 2.05319162663775882187e+0, 1.67638483018380384940e+0, 6.89767334985100004550e-1,
+                 1.48103976427480074590e-1, 1.51986665636164571966e-2, 5.47593808499534494600e-4,
+                 1.05075007164441684324e-9);
+    if (any(r > 5.)) {
+      const V rf = r - 5.;
+      const V far = horner(rf, 6.65790464350110377720e+0, 5.46378491116411436990e+0, 1.78482653991729133580e+0,
+                           2.96560571828504891230e-1, 2.65321895265761230930e-2, 1.24266094738807843860e-3,
+                           2.71155556874348757815e-5, 2.01033439929228813265e-7)
+          / horner(rf, 1., 5.99832206555887937690e-1, 1.36929880922735805310e-1, 1.48753612908506148525e-2,
+                   7.86869131145613259100e-4, 1.84631831751005468180e-5, 1.42151175831644588870e-7,
+                   2.04426310338993978564e-15);
+      tail = r <= 5. ? tail : far;
+    }
+    tail = q < 0. ? -tail : tail;
+    result = tails ? tail : result;
+  }
+  result = p == 0. ? splat<V>(-limits<double>::infinity()) : result;
+  result = p == 1. ? splat<V>(limits<double>::infinity()) : result;
+  result = (p < 0.) | (p > 1.) ? splat<V>(limits<double>::quiet_NaN()) : result;
+  return p != p ? p : result;
+}
+} // namespace impl
+
+/**
+ * inverse of the standard normal distribution lane by lane.
+ *
+ * @param p
+ * @return
+ */
+CQF_SIMD_INLINE batch<double, 2> norm_ppf(batch<double, 2> p) noexcept { return impl::norm_ppf_batch(p); }
+CQF_SIMD_INLINE batch<double, 4> norm_ppf(batch<double, 4> p) noexcept { return impl::norm_ppf_batch(p); }
+CQF_SIMD_INLINE batch<double, 8> norm_ppf(batch<double, 8> p) noexcept { return impl::norm_ppf_batch(p); }
+
+namespace impl {
+struct exp_kernel {
+  static constexpr double pad = 0.;
+  template<typename V>
+  CQF_SIMD_INLINE static V eval(V x) noexcept { return exp_batch(x); }
+};
+
+struct ln_kernel {
+  static constexpr double pad = 1.;
+  template<typename V>
+  CQF_SIMD_INLINE static V eval(V x) noexcept { return ln_batch(x); }
+};
+
+struct erf_kernel {
+  static constexpr double pad = 0.;
+  template<typename V>
+  CQF_SIMD_INLINE static V eval(V x) noexcept { return erf_batch(x); }
+};
+
+struct erfc_kernel {
+  static constexpr double pad = 0.;
+  template<typename V>
+  CQF_SIMD_INLINE static V eval(V x) noexcept { return erfc_batch(x); }
+};
+
+struct norm_ppf_kernel {
+  static constexpr double pad = 0.5;
+  template<typename V>
+  CQF_SIMD_INLINE static V eval(V x) noexcept { return norm_ppf_batch(x); }
+};
+
+struct sqrt_kernel {
+  static constexpr double pad = 1.;
+  template<typename V>
+  CQF_SIMD_INLINE static V eval(V x) noexcept { return simd::sqrt(x); }
+};
+
+/**
+ * applies a kernel to n contiguous elements, N lanes at a time.
+ * the trailing elements are padded into a full vector.
+ *
+ * @tparam Kernel
+ * @tparam N
+ * @param x
+ * @param y
+ * @param n
+ */
+template<typename Kernel, size_t N>
+CQF_SIMD_INLINE
+void apply(const double *x, double *y, size_t n) noexcept {
+  using V = batch<double, N>;
+  size_t i = 0;
+  for (; i + N <= n; i += N) {
+    V v;
+    std::memcpy(&v, x + i, sizeof(V));
+    v = Kernel::eval(v);
+    std::memcpy(y + i, &v, sizeof(V));
+  }
+  if (i < n) {
+    V v = splat<V>(Kernel::pad);
+    std::memcpy(&v, x + i, (n - i) * sizeof(double));
+    v = Kernel::eval(v);
+    std::memcpy(y + i, &v, (n - i) * sizeof(double));
+  }
+}
+
+template<typename Kernel>
+inline void apply_sse2(const double *x, double *y, size_t n) noexcept {
+  apply<Kernel, 2>(x, y, n);
+}
+
+#if CQF_SIMD_X86
+template<typename Kernel>
+__attribute__((target("avx2,fma")))
+inline void apply_avx2(const double *x, double *y, size_t n) noexcept {
+  apply<Kernel, 4>(x, y, n);
+}
+
+template<typename Kernel>
+__attribute__((target("avx512f")))
+inline void apply_avx512(const double *x, double *y, size_t n) noexcept {
+  apply<Kernel, 8>(x, y, n);
+}
+
+template<>
+__attribute__((target("avx2,fma")))
+inline void apply_avx2<sqrt_kernel>(const double *x, double *y, size_t n) noexcept {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(y + i, _mm256_sqrt_pd(_mm256_loadu_pd(x + i)));
+  }
+  apply<sqrt_kernel, 2>(x + i, y + i, n - i);
+}
+
+template<>
+__attribute__((target("avx512f")))
+inline void apply_avx512<sqrt_kernel>(const double *x, double *y, size_t n) noexcept {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    // the unmasked form passes an uninitialized source that gcc warns about
+    _mm512_storeu_pd(y + i, _mm512_mask_sqrt_pd(_mm512_setzero_pd(), 0xFF, _mm512_loadu_pd(x + i)));
+  }
+  apply<sqrt_kernel, 2>(x + i, y + i, n - i);
+}
+#endif
+
+/**
+ * the widest instruction set supported by the running processor.
+ *
+ * @return
+ */
+inline isa detect() noexcept {
+#if CQF_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return isa::avx512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return isa::avx2;
+#endif
+  return isa::sse2;
+}
+
+/**
+ * instruction set of the array entry points, read by the workers of a pool while select may write it.
+ * relaxed accesses suffice: the set only picks among kernels computing the same results.
+ *
+ * @return
+ */
+inline std::atomic<isa> &active() noexcept {
+  static std::atomic<isa> selected(detect());
+  return selected;
+}
+
+template<typename Kernel>
+inline void dispatch(const double *x, double *y, size_t n) noexcept {
+  switch (active().load(std::memory_order_relaxed)) {
+#if CQF_SIMD_X86
+    case isa::avx512: return apply_avx512<Kernel>(x, y, n);
+    case isa::avx2: return apply_avx2<Kernel>(x, y, n);
+#endif
+    default: return apply_sse2<Kernel>(x, y, n);
+  }
+}
+} // namespace impl
+
+/**
+ * whether the running processor supports an instruction set.
+ *
+ * @param set
+ * @return
+ */
+inline bool supported(isa set) noexcept {
+  return static_cast<int>(set) <= static_cast<int>(impl::detect());
+}
+
+/**
+ * instruction set currently used by the array entry points.
+ *
+ * @return
+ */
+inline isa selected() noexcept {
+  return impl::active().load(std::memory_order_relaxed);
+}
+
+/**
+ * forces the array entry points onto an instruction set, e.g. to compare paths against each other.
+ * falls back to the widest supported set if the requested one is not supported.
+ *
+ * @param set
+ */
+inline void select(isa set) noexcept {
+  impl::active().store(supported(set) ? set : impl::detect(), std::memory_order_relaxed);
+}
+
+/**
+ * y[i] = exp(x[i]) for i < n. x and y may alias.
+ *
+ * @param x
+ * @param y
+ * @param n
+ */
+inline void exp(const double *x, double *y, size_t n) noexcept {
+  impl::dispatch<impl::exp_kernel>(x, y, n);
+}
+
+/**
+ * y[i] = ln(x[i]) for i < n. x and y may alias.
+ *
+ * @param x
+ * @param y
+ * @param n
+ */
+inline void ln(const double *x, double *y, size_t n) noexcept {
+  impl::dispatch<impl::ln_kernel>(x, y, n);
+}
+
+/**
+ * y[i] = erf(x[i]) for i < n. x and y may alias.
+ *
+ * @param x
+ * @param y
+ * @param n
+ */
+inline void erf(const double *x, double *y, size_t n) noexcept {
+  impl::dispatch<impl::erf_kernel>(x, y, n);
+}
+
+/**
+ * y[i] = erfc(x[i]) for i < n. x and y may alias.
+ *
+ * @param x
+ * @param y
+ * @param n
+ */
+inline void erfc(const double *x, double *y, size_t n) noexcept {
+  impl::dispatch<impl::erfc_kernel>(x, y, n);
+}
+
+/**
+ * y[i] = sqrt(x[i]) for i < n. x and y may alias.
+ *
+ * @param x
+ * @param y
+ * @param n
+ */
+inline void sqrt(const double *x, double *y, size_t n) noexcept {
+  impl::dispatch<impl::sqrt_kernel>(x, y, n);
+}
+
+/**
+ * y[i] = norm_ppf(x[i]) for i < n. x and y may alias.
+ *
+ * @param x
+ * @param y
+ * @param n
+ */
+inline void norm_ppf(const double *x, double *y, size_t n) noexcept {
+  impl::dispatch<impl::norm_ppf_kernel>(x, y, n);
+}
+} // namespace simd
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_SIMD_H_
@@ -0,0 +1,166 @@
+//
+// Created by mamin on 12/24/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_SOBOL_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_SOBOL_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "traits.h"
+
+namespace cqf {
+/**
+ * number of dimensions with tabulated direction numbers.
+ */
+inline static constexpr size_t sobol_dimensions = 21;
+
+namespace impl {
+/**
+ * primitive polynomial of degree s over GF(2), its inner coefficients packed into a,
+ * along with the initial direction numbers m_1 ... m_s.
+ */
+struct sobol_polynomial {
+  uint32_t s;
+  uint32_t a;
+  uint32_t m[7];
+};
+
+/**
+ * dimensions 2 to 21 of Joe and Kuo's new-joe-kuo-6.21201 direction numbers,
+ * the first dimension being the van der Corput sequence.
+ */
+inline static constexpr sobol_polynomial joe_kuo[sobol_dimensions - 1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+    {6, 19, {1, 1, 1, 15, 7, 5}},
+    {6, 22, {1, 3, 1, 15, 13, 25}},
+    {6, 25, {1, 1, 5, 5, 19, 61}},
+    {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+    {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+};
+
+/**
+ * 32 direction numbers v_k = m_k / 2^k of every dimension, scaled to 32 bit integers,
+ * extended beyond the initial ones by the recurrence of the dimension's primitive polynomial.
+ *
+ * @return
+ */
+inline static constexpr
+std::array<std::array<uint32_t, 32>, sobol_dimensions>
+sobol_directions() noexcept {
+  std::array<std::array<uint32_t, 32>, sobol_dimensions> v{};
+  for (size_t k = 0; k < 32; ++k) {
+    v[0][k] = uint32_t{1} << (31 - k);
+  }
+  for (size_t d = 1; d < sobol_dimensions; ++d) {
+    const sobol_polynomial &p = joe_kuo[d - 1];
+    for (size_t k = 0; k < 32; ++k) {
+      if (k < p.s) {
+        v[d][k] = p.m[k] << (31 - k);
+        continue;
+      }
+      v[d][k] = v[d][k - p.s] ^ (v[d][k - p.s] >> p.s);
+      for (size_t i = 1; i < p.s; ++i) {
+        if ((p.a >> (p.s - 1 - i)) & 1) {
+          v[d][k] ^= v[d][k - i];
+        }
+      }
+    }
+  }
+  return v;
+}
+} // namespace impl
+
+/**
+ * Sobol direction numbers, generated at compile time.
+ */
+struct sobol_table {
+  inline static constexpr std::array<std::array<uint32_t, 32>, sobol_dimensions> directions = impl::sobol_directions();
+};
+
+/**
+ * Sobol low-discrepancy sequence in Dims dimensions, in Gray code order.
+ * <br/>
+ * The n-th point is the exclusive or of the direction numbers selected by the bits of the Gray code n ^ (n >> 1),
+ * so the sequence can be entered at any index in O(32) operations,
+ * and consecutive points differ by a single direction number.
+ * Threads splitting a run thus each start their own generator at the beginning of their share.
+ *
+ * @tparam Dims
+ */
+template<size_t Dims>
+class sobol {
+  static_assert(Dims >= 1 && Dims <= sobol_dimensions, "no direction numbers beyond sobol_dimensions");
+
+ private:
+  std::array<uint32_t, Dims> x{};
+  uint64_t index = 0;
+
+ public:
+  /**
+   * constructor.
+   *
+   * @param index of the first point to be generated, 0 being the origin
+   */
+  inline explicit constexpr
+  sobol(uint64_t index = 0) noexcept { skip(index); }
+
+  /**
+   * moves the sequence to the given index.
+   *
+   * @param n
+   */
+  inline constexpr
+  void
+  skip(uint64_t n) noexcept {
+    index = n;
+    const uint64_t gray = n ^ (n >> 1);
+    for (size_t d = 0; d < Dims; ++d) {
+      x[d] = 0;
+      for (size_t k = 0; k < 32; ++k) {
+        if ((gray >> k) & 1) {
+          x[d] ^= sobol_table::directions[d][k];
+        }
+      }
+    }
+  }
+
+  /**
+   * writes the current point to u, coordinates in [0, 1), and moves on to the next.
+   *
+   * @param u
+   */
+  inline constexpr
+  void
+  next(double *u) noexcept {
+    for (size_t d = 0; d < Dims; ++d) {
+      u[d] = static_cast<double>(x[d]) / 4294967296.;
+    }
+    size_t k = 0;
+    for (uint64_t n = index; n & 1; n >>= 1) {
+      ++k;
+    }
+    for (size_t d = 0; d < Dims; ++d) {
+      x[d] ^= sobol_table::directions[d][k];
+    }
+    ++index;
+  }
+};
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_SOBOL_H_
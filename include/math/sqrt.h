@@ -27,15 +27,26 @@ Float sqrt_impl(Float x) noexcept {
          impl::sqrt_recur(x, static_cast<Float>(1), static_cast<Float>(0), 1);
 }
 } // namespace impl
+/**
+ * square root
+ * Newton-Raphson's in constant expressions, std::sqrt otherwise
+ *
+ * @tparam Numeric
+ * @param x
+ * @return
+ */
 template<typename Numeric>
 inline static constexpr
 promoted<Numeric>
 sqrt(Numeric x) noexcept {
-#if  CQF_CONSTEXPR_STL_FALLBACK
-  return std::sqrt(x);
-#else
-  return impl::sqrt_impl(static_cast<promoted<Numeric>>(x));
-#endif
+  if constexpr (!std_math<promoted<Numeric>>) {
+    return impl::sqrt_impl(static_cast<promoted<Numeric>>(x));
+  } else {
+    if (CQF_CONSTANT_EVALUATED()) {
+      return impl::sqrt_impl(static_cast<promoted<Numeric>>(x));
+    }
+    return std::sqrt(static_cast<promoted<Numeric>>(x));
+  }
 }
 } // namespace cqf
 
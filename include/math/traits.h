@@ -10,25 +10,63 @@
 #include <type_traits>
 
 /**
- * Due to the fact that some compiler might treat standard math functions as constexpr functions,
- * the implementations may directly call these for maximized performance.
- * On to get rid of standard library implementations
+ * The implementations in this library are exact but recursive, and meant to be evaluated at compile time.
+ * Whenever a function is evaluated at runtime instead, it defers to the standard library, which is much faster.
+ * Define CQF_FORCE_NO_STL to 1 to get rid of standard library implementations altogether,
+ * e.g. to reproduce compile-time results bit for bit at runtime.
  */
-#define CQF_FORCE_NO_STL 1
+#ifndef CQF_FORCE_NO_STL
+#define CQF_FORCE_NO_STL 0
+#endif
 
-#ifndef _GLIBCXX_CONSTEXPR
-#define _GLIBCXX_CONSTEXPR
+/**
+ * whether the enclosing function is being evaluated in a constant expression.
+ * C++20 offers std::is_constant_evaluated, and gcc (9+) and clang (9+) offer the underlying builtin under C++17.
+ * Where neither is available, every evaluation is treated as a constant evaluation.
+ */
+#if CQF_FORCE_NO_STL
+#define CQF_CONSTANT_EVALUATED() true
+#elif defined(__cpp_lib_is_constant_evaluated)
+#define CQF_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define CQF_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#elif defined(__GNUC__) && __GNUC__ >= 9
+#define CQF_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#ifndef CQF_CONSTANT_EVALUATED
+#define CQF_CONSTANT_EVALUATED() true
 #endif
+
 /**
- * whether to fallback to constexpr std
+ * whether __float128 is supported, as the quadruple precision tier of the library.
+ * the standard library offers no elementary functions for it, which are then always evaluated
+ * by the implementations of this library, at runtime as well.
  */
-#define CQF_CONSTEXPR_STL_FALLBACK (_GLIBCXX_CONSTEXPR == constexpr && !CQF_FORCE_NO_STL)
+#ifndef CQF_HAS_FLOAT128
+#if defined(__GNUC__) && !defined(__clang__) && defined(__SIZEOF_FLOAT128__)
+#define CQF_HAS_FLOAT128 1
+#else
+#define CQF_HAS_FLOAT128 0
+#endif
+#endif
 
 /**
- * initial guess used in newton's method in search for the real implied volatility.
- * might somewhat affect convergence.
+ * high precision mode: define CQF_HIGH_PRECISION to 1 to carry the series of exp and erf in double-word arithmetic
+ * whenever they are evaluated for float, double and long double, that is in constant expressions,
+ * for results accurate to the last bit. Such evaluations cost several times as much, enough for
+ * the compile-time tables of norm_table.h to need a higher -fconstexpr-ops-limit.
  */
-#define CQF_DEFAULT_IMPLIED 0.5
+#ifndef CQF_HIGH_PRECISION
+#define CQF_HIGH_PRECISION 0
+#endif
+
+/**
+ * maximum number of Householder iterations in search for the real implied volatility.
+ * the initial guess is close enough for two or three iterations to suffice in practice.
+ */
+#define CQF_IMPLIED_MAX_ITERATIONS 32
 
 /**
  * initial guess used in newton's method in search for the real implied yield to maturity.
@@ -48,19 +86,110 @@
  */
 #define CQF_IMPLIED_ERROR_SCALE 1e2
 
+/**
+ * resolution of the compile-time normal distribution tables in norm_table.h:
+ * nodes per unit of x, and the bound beyond which the distribution is taken to be flat.
+ * the interpolation error shrinks with the fourth power of the node spacing.
+ */
+#define CQF_NORM_TABLE_STEPS 64
+#define CQF_NORM_TABLE_BOUND 8
+
+/**
+ * positions per task of the portfolio engine.
+ * a chunk of options takes a few tens of kilobytes, small enough to stay in cache while priced,
+ * and large enough to amortize scheduling.
+ */
+#define CQF_ENGINE_CHUNK 512
+
+/**
+ * samples per task of the Monte Carlo engine.
+ */
+#define CQF_MC_CHUNK 1024
+
 /**
  * maximum / minimum recurrences
  */
 #define CQF_MAX_TRIG_RECUR 16
 #define CQF_MAX_EXP_RECUR 32
 #define CQF_MAX_LOG_RECUR 512
+#define CQF_MAX_ERF_RECUR 128
+#define CQF_MAX_ERFC_RECUR 2048
 #define CQF_MAXIMUM_SIMPSON_PARTITION 65536
 #define CQF_MINIMUM_SIMPSON_PARTITION 16
+#define CQF_MAXIMUM_SIMPSON_DEPTH 48
+#define CQF_MAXIMUM_KRONROD_INTERVALS 512
+
+/**
+ * Gaussian quadrature: default number of nodes, and Newton's method on the roots of orthogonal polynomials
+ */
+#define CQF_GAUSS_NODES 32
+#define CQF_GAUSS_MAX_ITERATIONS 64
+#define CQF_GAUSS_ERROR_SCALE 4
+
+/**
+ * COS method: terms of the cosine series, half-width of the truncation range in units of sqrt(c2 + sqrt(c4)),
+ * and strikes summed together
+ */
+#define CQF_COS_TERMS 256
+#define CQF_COS_TRUNCATION 12
+#define CQF_COS_BLOCK 32
+
+/**
+ * finite differences: spot intervals and time steps, width of the grid concentration around the strike
+ * relative to K sigma sqrt(T), and upper end of the grid in standard deviations
+ */
+#define CQF_FD_SPACE_STEPS 400
+#define CQF_FD_TIME_STEPS 50
+#define CQF_FD_CONCENTRATION 0.5
+#define CQF_FD_BOUND 5
+
+/**
+ * lattices: time steps of binomial and trinomial trees
+ */
+#define CQF_LATTICE_STEPS 200
+
+/**
+ * yield curves: lookup cells per knot, and Newton's method on the knots while bootstrapping
+ */
+#define CQF_CURVE_CELLS 4
+#define CQF_CURVE_MAX_ITERATIONS 32
+#define CQF_CURVE_ERROR_SCALE 4
+
+/**
+ * algorithmic differentiation: nodes per block of a tape
+ */
+#define CQF_AAD_BLOCK 4096
+
+/**
+ * abscissae handed at once to the integrand by the composite Simpson's rule.
+ */
+#define CQF_INTEGRAL_BLOCK 64
+
+/**
+ * default relative tolerance of the adaptive integrators
+ */
+#define CQF_INTEGRAL_TOLERANCE 1e-12
 
 namespace cqf {
 
+/**
+ * whether a type is a real number: the floating point types, and the number types of algorithmic differentiation
+ * built on them, var and dual, which specialize this trait next to their definitions.
+ * such types run through every function templated on Float, and are kept as they are by promoted.
+ */
+template<typename Numeric>
+struct is_real : std::is_floating_point<Numeric> {};
+
+#if CQF_HAS_FLOAT128
+template<>
+struct is_real<__float128> : std::true_type {};
+#endif
+
+template<typename Numeric>
+inline constexpr bool is_real_v = is_real<Numeric>::value;
+
 template<typename... Numerics>
-using floating_guard = std::conjunction<std::is_floating_point<Numerics>...>;
+using floating_guard = std::conjunction<is_real<Numerics>...>;
 
 template<typename ... Numeric>
 using integral_guard = std::conjunction<std::is_integral<Numeric>...>;
@@ -75,18 +204,87 @@ template<typename... Numerics>
 using common = typename std::common_type_t<Numerics...>;
 
 template<typename Numeric>
-using promoted = std::conditional_t<std::is_floating_point_v<Numeric>, Numeric, double>;
+using promoted = std::conditional_t<is_real_v<Numeric>, Numeric, double>;
 
 template<typename... Numerics>
 using common_promoted = promoted<common<Numerics...>>;
 
+/**
+ * numeric limits of the standard library, completed for __float128.
+ *
+ * @tparam Numeric
+ */
 template<typename Numeric>
-using limits = std::numeric_limits<Numeric>;
+struct limits : std::numeric_limits<Numeric> {};
+
+#if CQF_HAS_FLOAT128
+namespace impl {
+/**
+ * 2^n in quadruple precision, by squaring.
+ *
+ * @param n
+ * @return
+ */
+inline static constexpr
+__float128
+power2_float128(int n) noexcept {
+  __float128 result = 1, x = n < 0 ? static_cast<__float128>(0.5) : static_cast<__float128>(2);
+  for (int k = n < 0 ? -n : n; k > 0; k /= 2) {
+    if (k % 2) result *= x;
+    if (k > 1) x *= x;
+  }
+  return result;
+}
+} // namespace impl
+
+template<>
+struct limits<__float128> : std::numeric_limits<long double> {
+ private:
+  static constexpr __float128 smallest = impl::power2_float128(-16382);
+  static constexpr __float128 largest = (2 - impl::power2_float128(-112)) * impl::power2_float128(16383);
+  static constexpr __float128 unit = impl::power2_float128(-112);
+  static constexpr __float128 subnormal = impl::power2_float128(-16494);
+
+ public:
+  static constexpr int digits = 113;
+  static constexpr int digits10 = 33;
+  static constexpr int max_digits10 = 36;
+  static constexpr int min_exponent = -16381;
+  static constexpr int min_exponent10 = -4931;
+  static constexpr int max_exponent = 16384;
+  static constexpr int max_exponent10 = 4932;
+  inline static constexpr __float128 min() noexcept { return smallest; }
+  inline static constexpr __float128 max() noexcept { return largest; }
+  inline static constexpr __float128 lowest() noexcept { return -largest; }
+  inline static constexpr __float128 epsilon() noexcept { return unit; }
+  inline static constexpr __float128 round_error() noexcept { return 0.5; }
+  inline static constexpr __float128 infinity() noexcept { return __builtin_infq(); }
+  inline static constexpr __float128 quiet_NaN() noexcept { return __builtin_nanq(""); }
+  inline static constexpr __float128 denorm_min() noexcept { return subnormal; }
+};
+#endif
+
+/**
+ * whether the standard library evaluates the elementary functions of a type at runtime.
+ * other types, such as __float128, are evaluated by the implementations of this library.
+ *
+ * @tparam Numeric
+ */
+template<typename Numeric>
+inline constexpr bool std_math = std::is_same_v<Numeric, float> || std::is_same_v<Numeric, double>
+    || std::is_same_v<Numeric, long double>;
 
 template<typename Dependent, typename... Ind>
 using function = std::function<Dependent(Ind...)>;
 
 template<typename Float, typename =floating_guard<Float>>
 using univariate_real_func = function<Float, Float>;
+
+/**
+ * whether a callable evaluates a whole array at once, as func(const Float *x, Float *y, size_t n) writing y[i] = f(x[i]).
+ * integrators hand such callables all abscissae of a rule in one call, so that the integrand can be vectorized.
+ */
+template<typename Func, typename Float>
+inline constexpr bool batch_func = std::is_invocable_v<const Func &, const Float *, Float *, size_t>;
 } // namespace cqf
 #endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MATH_TRAITS_H_
@@ -63,6 +63,16 @@ deg(Numeric x) noexcept {
 }
 
 namespace impl {
+/**
+ * terms of the Taylor series of sine and cosine on [-pi, pi): CQF_MAX_TRIG_RECUR reach the precision of long double,
+ * types wider than long double, such as __float128, take twice as many, whose last term is far below their epsilon.
+ *
+ * @tparam Float
+ */
+template<typename Float>
+inline constexpr size_t trig_recur = limits<Float>::digits > limits<long double>::digits
+                                     ? 2 * CQF_MAX_TRIG_RECUR : CQF_MAX_TRIG_RECUR;
+
 /**
  * iteratively expands sine function with Taylor series
  *
@@ -77,7 +87,7 @@ template<typename Float, typename  = floating_guard<Float>>
 inline static constexpr
 promoted<Float>
 sin_recur(Float x, Float acc, Float fac, size_t recur) noexcept {
-  return recur > CQF_MAX_TRIG_RECUR ? acc :
+  return recur > trig_recur<Float> ? acc :
          sin_recur(x, acc + fac,
                    -fac * x * x / (2. * static_cast<Float>(recur)) / (2. * static_cast<Float>(recur) + 1.), recur + 1);
 }
@@ -99,6 +109,8 @@ sin_impl(Float x) noexcept {
 
 /**
  * sine function
+ * evaluated by Taylor expansion of the wrapped angle in constant expressions and for types the standard library lacks,
+ * such as __float128, by std::sin otherwise
  *
  * @tparam Numeric
  * @param x
@@ -108,7 +120,14 @@ template<typename Numeric>
 inline static constexpr
 promoted<Numeric>
 sin(Numeric x) noexcept {
-  return impl::sin_impl(wrap_angle(x));
+  if constexpr (!std_math<promoted<Numeric>>) {
+    return impl::sin_impl(wrap_angle(x));
+  } else {
+    if (CQF_CONSTANT_EVALUATED()) {
+      return impl::sin_impl(wrap_angle(x));
+    }
+    return std::sin(static_cast<promoted<Numeric>>(x));
+  }
 }
 
 namespace impl {
@@ -126,7 +145,7 @@ template<typename Float, typename  = floating_guard<Float>>
 inline static constexpr
 promoted<Float>
 cos_recur(Float x, Float acc, Float fac, size_t recur) noexcept {
-  return recur > CQF_MAX_TRIG_RECUR ? acc :
+  return recur > trig_recur<Float> ? acc :
          cos_recur(x, acc + fac,
                    -fac * x * x / (2. * static_cast<Float>(recur)) / (2. * static_cast<Float>(recur) - 1.), recur + 1);
 }
@@ -152,6 +171,8 @@ cos_impl(Float x) noexcept {
 
 /**
  * cosine function
+ * evaluated by Taylor expansion of the wrapped angle in constant expressions and for types the standard library lacks,
+ * such as __float128, by std::cos otherwise
  *
  * @tparam Numeric
  * @param x
@@ -161,7 +182,14 @@ template<typename Numeric>
 inline static constexpr
 promoted<Numeric>
 cos(Numeric x) noexcept {
-  return impl::cos_impl(wrap_angle(x));
+  if constexpr (!std_math<promoted<Numeric>>) {
+    return impl::cos_impl(wrap_angle(x));
+  } else {
+    if (CQF_CONSTANT_EVALUATED()) {
+      return impl::cos_impl(wrap_angle(x));
+    }
+    return std::cos(static_cast<promoted<Numeric>>(x));
+  }
 }
 
 /**
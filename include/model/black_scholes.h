@@ -4,20 +4,103 @@
 #ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_BLACK_SCHOLES_H_
 #define CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_BLACK_SCHOLES_H_
 
+#include <type_traits>
+
 #include "math/traits.h"
 #include "math/erf.h"
+#include "math/exp.h"
 #include "math/log.h"
 #include "math/sqrt.h"
+#include "math/norm.h"
+#include "model/implied_volatility.h"
 
 namespace cqf {
 /**
- * base class for European style plain vanilla options.
+ * value and sensitivities of an option evaluated at once.
+ * theta and charm are sensitivities to the passage of calendar time, i.e. to -T.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct greeks {
+  Float premium;  // value of option
+  Float delta;    // dV / dS
+  Float gamma;    // d^2V / dS^2
+  Float vega;     // dV / d sigma
+  Float theta;    // dV / dt
+  Float rho;      // dV / dr
+  Float vanna;    // d^2V / dS d sigma
+  Float volga;    // d^2V / d sigma^2
+  Float charm;    // d delta / dt
+};
+
+namespace impl {
+/**
+ * black scholes value and Greeks of a European plain vanilla option.
+ * every transcendental term (one ln, one sqrt, two exp, two norm_cdf and one norm_pdf)
+ * is computed once and shared among all quantities.
+ * calls and puts share the same formulae through omega = +1 / -1.
  *
  * @tparam Float
+ * @param omega +1 for calls, -1 for puts
+ * @param S
+ * @param K
+ * @param T
+ * @param r
+ * @param q
+ * @param sigma
+ * @return
  */
 template<typename Float, typename = floating_guard<Float>>
-class vanilla_template {
- protected:
+inline static constexpr
+greeks<Float>
+black_scholes_greeks(Float omega, Float S, Float K, Float T, Float r, Float q, Float sigma) noexcept {
+  const Float sqrt_T = sqrt(T);
+  const Float vol = sigma * sqrt_T;                                    // total volatility
+  const Float d1 = (ln(S / K) + (r - q + static_cast<Float>(0.5) * sigma * sigma) * T) / vol;
+  const Float d2 = d1 - vol;
+
+  const Float dq = exp(-q * T);                                        // dividend discount factor
+  const Float SPV = S * dq;                                            // discounted underlying
+  const Float KPV = K * exp(-r * T);                                   // discounted strike
+
+  const Float Nd1 = norm_cdf(omega * d1);
+  const Float Nd2 = norm_cdf(omega * d2);
+  const Float pdf = norm_pdf(d1);
+  const Float vega = SPV * pdf * sqrt_T;
+
+  return greeks<Float>{
+      /*premium*/ omega * (SPV * Nd1 - KPV * Nd2),
+      /*delta*/ omega * dq * Nd1,
+      /*gamma*/ dq * pdf / (S * vol),
+      /*vega*/ vega,
+      /*theta*/ -SPV * pdf * sigma / (2 * sqrt_T) - omega * r * KPV * Nd2 + omega * q * SPV * Nd1,
+      /*rho*/ omega * T * KPV * Nd2,
+      /*vanna*/ -dq * pdf * d2 / sigma,
+      /*volga*/ vega * d1 * d2 / sigma,
+      /*charm*/ omega * q * dq * Nd1 - dq * pdf * (2 * (r - q) * T - d2 * vol) / (2 * T * vol)
+  };
+}
+} // namespace impl
+
+/**
+ * exercise side of an option.
+ */
+enum class option_side { call, put };
+
+/**
+ * European style plain vanilla options.
+ * <br/>
+ * The side is a template parameter, so that calls and puts share one implementation without virtual dispatch.
+ * Instances are trivially copyable and hold nothing but the six model parameters,
+ * which makes them suitable for dense storage in large portfolio vectors.
+ *
+ * @tparam Float
+ * @tparam Side
+ */
+template<typename Float, option_side Side, typename = floating_guard<Float>>
+class vanilla {
+ private:
   Float S;        // spot underlying
   Float K;        // strike
   Float T;        // time to maturity
@@ -25,6 +108,10 @@ class vanilla_template {
   Float q;        // dividend rate
   Float sigma;    // implied volatility
 
+  /**
+   * +1 for calls, -1 for puts.
+   */
+  static constexpr Float omega = Side == option_side::call ? static_cast<Float>(1) : static_cast<Float>(-1);
 
  public:
   /**
@@ -38,9 +125,42 @@ class vanilla_template {
    * @param sigma implied volatility
    */
   inline explicit constexpr
-  vanilla_template(Float S, Float K, Float T, Float r, Float q, Float sigma)
+  vanilla(Float S, Float K, Float T, Float r, Float q, Float sigma)
       : S(S), K(K), T(T), r(r), q(q), sigma(sigma) {}
 
+  /**
+   * constructor, discounting on a term structure.
+   * a European option only depends on the curve through its zero rate to maturity.
+   *
+   * @tparam Curve term structure with Float zero_rate(Float t) const, e.g. yield_curve
+   * @param S underlying spot price
+   * @param K strike price
+   * @param T time to maturity
+   * @param rates risk-free yield curve
+   * @param q dividend paying rate of underlying
+   * @param sigma implied volatility
+   */
+  template<typename Curve, typename = std::enable_if_t<!std::is_convertible_v<Curve, Float>>>
+  inline constexpr
+  vanilla(Float S, Float K, Float T, const Curve &rates, Float q, Float sigma)
+      : vanilla(S, K, T, rates.zero_rate(T), q, sigma) {}
+
+  /**
+   * constructor, discounting on a term structure and with a term structure of dividend yields.
+   *
+   * @tparam Curve term structure with Float zero_rate(Float t) const, e.g. yield_curve
+   * @param S underlying spot price
+   * @param K strike price
+   * @param T time to maturity
+   * @param rates risk-free yield curve
+   * @param dividends dividend yield curve of underlying
+   * @param sigma implied volatility
+   */
+  template<typename Curve, typename = std::enable_if_t<!std::is_convertible_v<Curve, Float>>>
+  inline constexpr
+  vanilla(Float S, Float K, Float T, const Curve &rates, const Curve &dividends, Float sigma)
+      : vanilla(S, K, T, rates.zero_rate(T), dividends.zero_rate(T), sigma) {}
+
   /**
    * black scholes d1.
    * un-discounted delta.
@@ -49,7 +169,7 @@ class vanilla_template {
    */
   inline constexpr
   Float d1() const {
-    return (ln(S / K) + (r - q + 0.5 * sigma * sigma) * T) / sigma * sqrt(T);
+    return (ln(S / K) + (r - q + 0.5 * sigma * sigma) * T) / (sigma * sqrt(T));
   }
 
   /**
@@ -60,7 +180,7 @@ class vanilla_template {
    */
   inline constexpr
   Float d2() const {
-    return (ln(S / K) + (r - q - 0.5 * sigma * sigma) * T) / sigma * sqrt(T);
+    return (ln(S / K) + (r - q - 0.5 * sigma * sigma) * T) / (sigma * sqrt(T));
   }
 
   /**
@@ -91,40 +211,48 @@ class vanilla_template {
    *
    * @return
    */
-  inline virtual Float premium() const { return 0; };
+  inline constexpr
+  Float premium() const {
+    return omega * (SPV() * norm_cdf(omega * d1()) - KPV() * norm_cdf(omega * d2()));
+  }
 
   /**
    * delta of option.
    * sensitivity of option value with respect to underlying price.
-   * Delta = dV / dS.
-   *
-   * Virtual implementation. real implementations depend on whether the option is call or put.
+   * Delta = dV / dS
    *
    * @return
    */
-  inline virtual Float delta() const { return 0; };
+  inline constexpr
+  Float delta() const {
+    return omega * exp(-q * T) * norm_cdf(omega * d1());
+  }
 
   /**
    * theta of option.
    * sensitivity of option value with respect to time to maturity
-   * Theta = dV / d tau.
-   *
-   * Virtual implementation. real implementations depend on whether the option is call or put.
+   * Theta = dV / d tau
    *
    * @return
    */
-  inline virtual Float theta() const { return 0; }
+  inline constexpr
+  Float theta() const {
+    return -exp(-q * T) * S * norm_pdf(d1()) * sigma / 2. / sqrt(T)
+        - omega * r * KPV() * norm_cdf(omega * d2())
+        + omega * q * SPV() * norm_cdf(omega * d1());
+  }
 
   /**
    * rho of option.
-   * sensitivity of option value with respect to risk-free interest rate.
-   * Rho = dV / dr.
-   *
-   * Virtual implementation. real implementations depend on whether the option is call or put.
+   * sensitivity of option value with respect to risk-free interest rate
+   * Rho = dV / dr
    *
    * @return
    */
-  inline virtual Float rho() const { return 0; }
+  inline constexpr
+  Float rho() const {
+    return omega * T * KPV() * norm_cdf(omega * d2());
+  }
 
   /**
    * gamma of option.
@@ -151,81 +279,21 @@ class vanilla_template {
   inline constexpr Float vega() const {
     return SPV() * norm_pdf(d1()) * sqrt(T);
   }
-};
-
-/**
- * plain vanilla call options.
- *
- * @tparam Float
- */
-template<typename Float, typename = floating_guard<Float>>
-class call_vanilla : public vanilla_template<Float> {
- public:
-  /**
-   * constructor.
-   *
-   * @param S
-   * @param K
-   * @param T
-   * @param r
-   * @param q
-   * @param sigma
-   */
-  inline explicit constexpr
-  call_vanilla(Float S, Float K, Float T, Float r, Float q, Float sigma)
-      : vanilla_template<Float>(S, K, T, r, q, sigma) {}
-
-  /**
-   * value of option.
-   *
-   * @return
-   */
-  inline constexpr
-  Float premium() const {
-    return this->SPV() * norm_cdf(this->d1()) - this->KPV() * norm_cdf(this->d2());
-  }
-
-  /**
-   * delta of option.
-   * sensitivity of option value with respect to underlying price.
-   * Delta = dV / dS
-   *
-   * @return
-   */
-  inline constexpr
-  Float delta() const {
-    return exp(-this->q * this->T) * norm_cdf(this->d1());
-  }
 
   /**
-   * theta of option.
-   * sensitivity of option value with respect to time to maturity
-   * Theta = dV / d tau
+   * value of option together with all first and second order Greeks,
+   * sharing the transcendental terms among them.
    *
    * @return
    */
   inline constexpr
-  Float theta() const {
-    return -exp(-this->q * this->T) * this->S * norm_pdf(this->d1()) * this->sigma / 2. / sqrt(this->T)
-        - this->r * this->KPV() * norm_cdf(this->d2())
-        + this->q * this->SPV() * norm_cdf(this->d1());
-  }
-
-  /**
-   * rho of option.
-   * sensitivity of option value with respect to risk-free interest rate
-   * Rho = dV / dr
-   *
-   * @return
-   */
-  inline constexpr
-  Float rho() const {
-    return this->T * this->KPV() * norm_cdf(this->d2());
+  greeks<Float> evaluate() const {
+    return impl::black_scholes_greeks(omega, S, K, T, r, q, sigma);
   }
 
   /**
    * compute the implied volatility from the provided information,
-   * and returns a plain vanilla call option instance with the computed implied volatility.
+   * and returns a plain vanilla option instance with the computed implied volatility.
    *
    * @param S
    * @param K
@@ -236,140 +304,28 @@ class call_vanilla : public vanilla_template<Float> {
    * @return
    */
   inline static constexpr
-  call_vanilla<Float>
+  vanilla<Float, Side>
   implied(Float S, Float K, Float T, Float r, Float q, Float price) {
-    return implied_newt(call_vanilla<Float>(S, K, T, r, q, CQF_DEFAULT_IMPLIED), price);
-  }
-
- private:
-  /**
-   * uses newton's method to compute implied volatility.
-   *
-   * @param op
-   * @param price
-   * @return
-   */
-  inline static constexpr
-  call_vanilla<Float>
-  implied_newt(call_vanilla<Float> op, Float price) {
-    return CQF_IMPLIED_ERROR_SCALE /*scaling factor to machine epsilon to compare with absolute error, this is sad*/
-               * limits<Float>::epsilon() * price > abs(op.premium() - price)
-           /*if error is acceptable*/ ? op :
-           /*else*/ implied_newt(
-            /*new option */ call_vanilla<Float>(op.S, op.K, op.T, op.r, op.q,
-                /*new sigma by newton's*/ op.sigma - (/*func value*/op.premium() - price) / /*derivative*/ op.vega()),
-            /*price unchanged*/ price);
+    return vanilla<Float, Side>(S, K, T, r, q,
+                                cqf::implied_volatility(Side == option_side::call, S, K, T, r, q, price));
   }
 };
 
 /**
- * plain vanilla put options.
+ * plain vanilla call options.
  *
  * @tparam Float
  */
-template<typename Float, typename = floating_guard<Float>>
-class put_vanilla : public vanilla_template<Float> {
- public:
-  /**
-   * constructor.
-   *
-   * @param S
-   * @param K
-   * @param T
-   * @param r
-   * @param q
-   * @param sigma
-   */
-  inline explicit constexpr
-  put_vanilla(Float S, Float K, Float T, Float r, Float q, Float sigma)
-      : vanilla_template<Float>(S, K, T, r, q, sigma) {}
-
-  /**
-   * value of option.
-   *
-   * @return
-   */
-  inline constexpr
-  Float premium() const {
-    return -this->SPV() * norm_cdf(-this->d1()) + this->KPV() * norm_cdf(-this->d2());
-  }
-
-  /**
-   * delta of option.
-   * sensitivity of option value with respect to underlying price.
-   * Delta = dV / dS
-   *
-   * @return
-   */
-  inline constexpr
-  Float delta() const {
-    return -exp(-this->q * this->T) * norm_cdf(-this->d1());
-  }
-
-  /**
-   * theta of option.
-   * sensitivity of option value with respect to time to maturity
-   * Theta = dV / d tau
-   *
-   * @return
-   */
-  inline constexpr
-  Float theta() const {
-    return -exp(-this->q * this->T) * this->S * norm_pdf(-this->d1()) * this->sigma / 2. / sqrt(this->T)
-        + this->r * this->KPV() * norm_cdf(-this->d2())
-        - this->q * this->SPV() * norm_cdf(-this->d1());
-  }
-
-  /**
-   * rho of option.
-   * sensitivity of option value with respect to risk-free interest rate
-   * Rho = dV / dr
-   *
-   * @return
-   */
-  inline constexpr
-  Float rho() const {
-    return -this->T * this->KPV() * norm_cdf(-this->d2());
-  }
-
-  /**
-   * compute the implied volatility from the provided information,
-   * and returns a plain vanilla put option instance with the computed implied volatility.
-   *
-   * @param S
-   * @param K
-   * @param T
-   * @param r
-   * @param q
-   * @param price
-   * @return
-   */
-  inline static constexpr
-  put_vanilla<Float>
-  implied(Float S, Float K, Float T, Float r, Float q, Float price) {
-    return implied_newt(put_vanilla<Float>(S, K, T, r, q, CQF_DEFAULT_IMPLIED), price);
-  }
+template<typename Float>
+using call_vanilla = vanilla<Float, option_side::call>;
 
- private:
-  /**
-   * uses newton's method to compute implied volatility.
-   *
-   * @param op
-   * @param price
-   * @return
-   */
-  inline static constexpr
-  put_vanilla<Float>
-  implied_newt(put_vanilla<Float> op, Float price) {
-    return CQF_IMPLIED_ERROR_SCALE /*scaling factor to machine epsilon to compare with absolute error, this is sad*/
-               * limits<Float>::epsilon() > abs(op.premium() - price)
-           /*if error is acceptable*/ ? op :
-           /*else*/ implied_newt(
-            /*new option */ put_vanilla<Float>(op.S, op.K, op.T, op.r, op.q,
-                /*new sigma*/ op.sigma - (/*func value*/op.premium() - price) / /*derivative*/ op.vega()),
-            /*price unchanged*/ price);
-  }
-};
+/**
+ * plain vanilla put options.
+ *
+ * @tparam Float
+ */
+template<typename Float>
+using put_vanilla = vanilla<Float, option_side::put>;
 } // namespace cqf
 
 #endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_BLACK_SCHOLES_H_
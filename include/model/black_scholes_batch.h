@@ -0,0 +1,200 @@
+//
+// Created by mamin on 12/18/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_BLACK_SCHOLES_BATCH_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_BLACK_SCHOLES_BATCH_H_
+
+#include <cstddef>
+
+#include "math/traits.h"
+#include "math/exp.h"
+#include "math/log.h"
+#include "math/sqrt.h"
+#include "math/norm.h"
+#include "math/simd.h"
+#include "model/black_scholes.h"
+#include "model/implied_volatility.h"
+
+namespace cqf {
+/**
+ * structure-of-arrays view over a chain of European plain vanilla options.
+ * every array holds at least size elements, the i-th contract being (S[i], K[i], T[i], r[i], q[i], sigma[i]).
+ * the view does not own any of the arrays.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct vanilla_chain {
+  const Float *S;         // spot underlying
+  const Float *K;         // strike
+  const Float *T;         // time to maturity
+  const Float *r;         // risk-free interest rate
+  const Float *q;         // dividend rate
+  const Float *sigma;     // implied volatility
+  const bool *call;       // true for calls, false for puts
+  size_t size;            // number of contracts
+};
+
+/**
+ * structure-of-arrays output of a batch evaluation.
+ * every array must be able to hold as many elements as the chain it is paired with.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct vanilla_chain_greeks {
+  Float *premium;         // value of option
+  Float *delta;           // dV / dS
+  Float *gamma;           // d^2V / dS^2
+  Float *vega;            // dV / d sigma
+  Float *theta;           // dV / dt
+  Float *rho;             // dV / dr
+};
+
+namespace impl {
+/**
+ * prices a single contract of the chain and writes premium and Greeks to the i-th slot of the output.
+ *
+ * @tparam Float
+ * @param in
+ * @param out
+ * @param i
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+void
+price_chain_at(const vanilla_chain<Float> &in, const vanilla_chain_greeks<Float> &out, size_t i) noexcept {
+  const greeks<Float> g = black_scholes_greeks(in.call[i] ? static_cast<Float>(1) : static_cast<Float>(-1),
+                                               in.S[i], in.K[i], in.T[i], in.r[i], in.q[i], in.sigma[i]);
+  out.premium[i] = g.premium;
+  out.delta[i] = g.delta;
+  out.gamma[i] = g.gamma;
+  out.vega[i] = g.vega;
+  out.theta[i] = g.theta;
+  out.rho[i] = g.rho;
+}
+} // namespace impl
+
+/**
+ * prices a whole chain of European plain vanilla options in one pass over contiguous arrays,
+ * writing premiums and Greeks into the output arrays.
+ * equivalent to constructing a call_vanilla / put_vanilla per contract and querying every method,
+ * without the per-contract objects and without recomputing d1, d2 and discount factors per quantity.
+ *
+ * @tparam Float
+ * @param in input chain
+ * @param out output arrays
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+void
+price_chain(const vanilla_chain<Float> &in, const vanilla_chain_greeks<Float> &out) noexcept {
+  for (size_t i = 0; i < in.size; ++i) {
+    impl::price_chain_at(in, out, i);
+  }
+}
+
+/**
+ * implied volatilities of a whole chain of European plain vanilla options from their traded prices.
+ * the sigma array of the input chain is not read and may be null,
+ * and may equally point to the output, so that the chain can be priced right after with price_chain.
+ *
+ * @tparam Float
+ * @param in input chain
+ * @param price traded prices
+ * @param sigma output implied volatilities, nan wherever a price violates no-arbitrage bounds
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+void
+implied_chain(const vanilla_chain<Float> &in, const Float *price, Float *sigma) noexcept {
+  for (size_t i = 0; i < in.size; ++i) {
+    sigma[i] = implied_volatility(in.call[i], in.S[i], in.K[i], in.T[i], in.r[i], in.q[i], price[i]);
+  }
+}
+
+namespace impl {
+/**
+ * prices contracts [begin, begin + n) of a double precision chain, n no greater than CQF_SIMD_BLOCK.
+ * the transcendental terms of the whole block are evaluated by the array kernels in simd.h,
+ * everything else is plain arithmetic over the block.
+ * N(omega d) is taken as erfc(-omega d / sqrt(2)) / 2, as norm_cdf does, so that the tails keep their relative precision.
+ *
+ * @param in
+ * @param out
+ * @param begin
+ * @param n
+ */
+inline static
+void
+price_chain_block(const vanilla_chain<double> &in, const vanilla_chain_greeks<double> &out,
+                  size_t begin, size_t n) noexcept {
+  double sqrt_T[CQF_SIMD_BLOCK], moneyness[CQF_SIMD_BLOCK], dq[CQF_SIMD_BLOCK], dr[CQF_SIMD_BLOCK];
+  double d1[CQF_SIMD_BLOCK], Nd1[CQF_SIMD_BLOCK], Nd2[CQF_SIMD_BLOCK], pdf[CQF_SIMD_BLOCK];
+
+  const double *S = in.S + begin, *K = in.K + begin, *T = in.T + begin;
+  const double *r = in.r + begin, *q = in.q + begin, *sigma = in.sigma + begin;
+  const bool *call = in.call + begin;
+  constexpr double inv_sqrt_2pi = 1. / sqrt(constants<double>::_2pi);
+
+  simd::sqrt(T, sqrt_T, n);
+  for (size_t i = 0; i < n; ++i) {
+    moneyness[i] = S[i] / K[i];
+    dq[i] = -q[i] * T[i];
+    dr[i] = -r[i] * T[i];
+  }
+  simd::ln(moneyness, moneyness, n);
+  simd::exp(dq, dq, n);
+  simd::exp(dr, dr, n);
+
+  for (size_t i = 0; i < n; ++i) {
+    const double omega = call[i] ? 1. : -1.;
+    const double vol = sigma[i] * sqrt_T[i];
+    d1[i] = (moneyness[i] + (r[i] - q[i] + 0.5 * sigma[i] * sigma[i]) * T[i]) / vol;
+    Nd1[i] = -omega * d1[i] / constants<double>::sqrt2;
+    Nd2[i] = -omega * (d1[i] - vol) / constants<double>::sqrt2;
+    pdf[i] = -0.5 * d1[i] * d1[i];
+  }
+  simd::erfc(Nd1, Nd1, n);
+  simd::erfc(Nd2, Nd2, n);
+  simd::exp(pdf, pdf, n);
+
+  for (size_t i = 0; i < n; ++i) {
+    const double omega = call[i] ? 1. : -1.;
+    const double N1 = 0.5 * Nd1[i];
+    const double N2 = 0.5 * Nd2[i];
+    const double phi = pdf[i] * inv_sqrt_2pi;
+    const double SPV = S[i] * dq[i];
+    const double KPV = K[i] * dr[i];
+
+    out.premium[begin + i] = omega * (SPV * N1 - KPV * N2);
+    out.delta[begin + i] = omega * dq[i] * N1;
+    out.gamma[begin + i] = dq[i] * phi / (S[i] * sigma[i] * sqrt_T[i]);
+    out.vega[begin + i] = SPV * phi * sqrt_T[i];
+    out.theta[begin + i] = -SPV * phi * sigma[i] / (2. * sqrt_T[i])
+        - omega * r[i] * KPV * N2
+        + omega * q[i] * SPV * N1;
+    out.rho[begin + i] = omega * T[i] * KPV * N2;
+  }
+}
+} // namespace impl
+
+/**
+ * prices a whole chain of double precision European plain vanilla options.
+ * the chain is processed in blocks of CQF_SIMD_BLOCK contracts,
+ * each block evaluating its logarithms, exponentials, square roots and normal distributions
+ * through the vectorized kernels of the widest instruction set available at runtime.
+ *
+ * @param in input chain
+ * @param out output arrays
+ */
+inline static
+void
+price_chain(const vanilla_chain<double> &in, const vanilla_chain_greeks<double> &out) noexcept {
+  for (size_t begin = 0; begin < in.size; begin += CQF_SIMD_BLOCK) {
+    impl::price_chain_block(in, out, begin, min(static_cast<size_t>(CQF_SIMD_BLOCK), in.size - begin));
+  }
+}
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_BLACK_SCHOLES_BATCH_H_
@@ -0,0 +1,99 @@
+//
+// Created by mamin on 12/24/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_BROWNIAN_BRIDGE_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_BROWNIAN_BRIDGE_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "math/traits.h"
+#include "math/sqrt.h"
+
+namespace cqf {
+/**
+ * Brownian bridge construction of a Brownian motion on evenly spaced dates 1, ..., steps.
+ * <br/>
+ * The first draw fixes the terminal value, the second the midpoint, then the quarter points and so on,
+ * each point being sampled conditionally on its already built neighbours.
+ * The leading draws thus carry most of the variance of the path,
+ * which concentrates the effective dimension onto the best distributed coordinates of a Sobol sequence.
+ */
+class brownian_bridge {
+ private:
+  size_t steps;
+  std::vector<size_t> bridge, left, right;
+  std::vector<double> left_weight, right_weight, deviation;
+
+ public:
+  /**
+   * constructor, precomputing the construction order and conditional weights.
+   *
+   * @param steps number of dates
+   */
+  inline explicit
+  brownian_bridge(size_t steps)
+      : steps(steps), bridge(steps), left(steps), right(steps),
+        left_weight(steps), right_weight(steps), deviation(steps) {
+    if (steps == 0) {
+      return;
+    }
+    // map[i] != 0 once date i + 1 is built
+    std::vector<size_t> map(steps, 0);
+    map[steps - 1] = 1;
+    bridge[0] = steps - 1;
+    deviation[0] = sqrt(static_cast<double>(steps));
+    for (size_t i = 1, j = 0; i < steps; ++i) {
+      while (map[j]) ++j;
+      size_t k = j;
+      while (!map[k]) ++k;
+      // dates j + 1 ... k are unknown up to k, built one, bridge the middle one l between j and k + 1
+      const size_t l = j + ((k - 1 - j) >> 1);
+      map[l] = i;
+      bridge[i] = l;
+      left[i] = j;
+      right[i] = k;
+      const auto tj = static_cast<double>(j), tk = static_cast<double>(k + 1), tl = static_cast<double>(l + 1);
+      left_weight[i] = (tk - tl) / (tk - tj);
+      right_weight[i] = (tl - tj) / (tk - tj);
+      deviation[i] = sqrt((tl - tj) * (tk - tl) / (tk - tj));
+      j = k + 1;
+      if (j >= steps) j = 0;
+    }
+  }
+
+  /**
+   * number of dates.
+   *
+   * @return
+   */
+  inline
+  size_t
+  size() const noexcept { return steps; }
+
+  /**
+   * turns independent standard normal draws into the unit increments of a Brownian path.
+   * the increments are again independent standard normals, in the order of the dates.
+   *
+   * @param z draws, z[0] fixing the terminal value
+   * @param dw output increments, may not alias z
+   */
+  inline
+  void
+  transform(const double *z, double *dw) const noexcept {
+    if (steps == 0) {
+      return;
+    }
+    dw[steps - 1] = deviation[0] * z[0];
+    for (size_t i = 1; i < steps; ++i) {
+      const size_t j = left[i], k = right[i], l = bridge[i];
+      dw[l] = (j ? left_weight[i] * dw[j - 1] : 0.) + right_weight[i] * dw[k] + deviation[i] * z[i];
+    }
+    for (size_t i = steps - 1; i > 0; --i) {
+      dw[i] -= dw[i - 1];
+    }
+  }
+};
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_BROWNIAN_BRIDGE_H_
@@ -0,0 +1,253 @@
+//
+// Created by mamin on 12/26/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_COS_METHOD_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_COS_METHOD_H_
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "math/traits.h"
+#include "math/basic.h"
+#include "math/constants.h"
+#include "math/exp.h"
+#include "math/log.h"
+#include "math/sqrt.h"
+#include "math/trig.h"
+
+namespace cqf {
+/**
+ * geometric Brownian motion, characteristic function of the martingale part of ln(S_T / S_0),
+ * phi(u) = exp(-sigma^2 T (iu + u^2) / 2).
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct gbm {
+  Float sigma;  // volatility
+
+  inline
+  std::complex<Float>
+  operator()(Float u, Float T) const {
+    return std::exp(std::complex<Float>(-sigma * sigma * T * u * u / 2, -sigma * sigma * T * u / 2));
+  }
+};
+
+/**
+ * Heston stochastic volatility, dv = kappa (theta - v) dt + xi sqrt(v) dW, d<W, W_S> = rho dt.
+ * the characteristic function is written in the form of Albrecher et al., whose complex logarithm
+ * stays on its principal branch for any maturity.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct heston {
+  Float kappa;  // mean reversion speed
+  Float theta;  // long run variance
+  Float xi;     // volatility of variance
+  Float rho;    // correlation of variance and underlying
+  Float v0;     // initial variance
+
+  inline
+  std::complex<Float>
+  operator()(Float u, Float T) const {
+    using complex = std::complex<Float>;
+    const complex iu(0, u);
+    const complex beta = kappa - rho * xi * iu;
+    const complex d = std::sqrt(beta * beta + xi * xi * (u * u + iu));
+    const complex g = (beta - d) / (beta + d);
+    const complex e = std::exp(-d * T), one(1, 0);
+    const complex C = kappa * theta / (xi * xi) * ((beta - d) * T - static_cast<Float>(2) * std::log((one - g * e) / (one - g)));
+    const complex D = (beta - d) / (xi * xi) * (one - e) / (one - g * e);
+    return std::exp(C + D * v0);
+  }
+};
+
+/**
+ * variance gamma, Brownian motion with drift theta and volatility sigma subordinated to a gamma process
+ * of unit mean rate and variance rate nu, compensated to a martingale.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct variance_gamma {
+  Float sigma;  // volatility of the Brownian motion
+  Float nu;     // variance rate of the gamma time change
+  Float theta;  // drift of the Brownian motion
+
+  inline
+  std::complex<Float>
+  operator()(Float u, Float T) const {
+    using complex = std::complex<Float>;
+    const Float omega = ln(1 - theta * nu - sigma * sigma * nu / 2) / nu;
+    return std::exp(complex(0, u * omega * T))
+        * std::pow(complex(1 + sigma * sigma * nu * u * u / 2, -theta * nu * u), -T / nu);
+  }
+};
+
+namespace impl {
+/**
+ * cumulants of ln(S_T / S_0) read off the characteristic function close to the origin,
+ * whose logarithm is i c1 h - c2 h^2 / 2 + c4 h^4 / 24 + O(h^3, h^6) on the real and imaginary parts.
+ * the variance is first estimated at a tiny h, then c2 and c4 are separated by Richardson extrapolation
+ * between h and 2h, h being scaled to a tenth of a standard deviation in frequency.
+ *
+ * @tparam Float
+ * @tparam Model
+ * @param model
+ * @param T
+ * @param drift (r - q) T
+ * @param c1 mean
+ * @param c2 variance
+ * @param c4 fourth cumulant, zero for a normal distribution
+ */
+template<typename Float, typename Model, typename = floating_guard<Float>>
+inline
+void
+cos_cumulants(const Model &model, Float T, Float drift, Float &c1, Float &c2, Float &c4) {
+  constexpr Float tiny = static_cast<Float>(1e-3);
+  const std::complex<Float> l = std::log(model(tiny, T));
+  c1 = drift + l.imag() / tiny;
+  c2 = max(-2 * l.real() / (tiny * tiny), limits<Float>::epsilon());
+
+  const Float h = static_cast<Float>(0.1) / sqrt(c2);
+  const Float r1 = std::log(model(h, T)).real(), r2 = std::log(model(2 * h, T)).real();
+  c2 = max((r2 - 16 * r1) / (6 * h * h), limits<Float>::epsilon());
+  c4 = max(2 * (r2 - 4 * r1) / (h * h * h * h), static_cast<Float>(0));
+}
+
+/**
+ * cosine coefficients of the put payoff max(1 - e^y, 0) over [a, b], y = ln(S_T / K),
+ * U_k = 2 / (b - a) (psi_k(a, 0) - chi_k(a, 0)), the first one halved as the cosine series requires.
+ *
+ * @tparam Float
+ * @param a
+ * @param b
+ * @param U output, terms coefficients
+ * @param terms
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline
+void
+cos_put_coefficients(Float a, Float b, Float *U, size_t terms) {
+  const Float d = min(b, static_cast<Float>(0));
+  if (d <= a) {
+    std::fill(U, U + terms, static_cast<Float>(0));
+    return;
+  }
+  const Float ea = exp(a), ed = exp(d);
+  // cos and sin of u_k (d - a), k pi (d - a) / (b - a), by rotation
+  const Float angle = constants<Float>::pi * (d - a) / (b - a);
+  const Float wr = cos(angle), wi = sin(angle);
+  Float cd = 1, sd = 0;
+  for (size_t k = 0; k < terms; ++k) {
+    const Float u = static_cast<Float>(k) * constants<Float>::pi / (b - a);
+    const Float chi = (cd * ed - ea + u * sd * ed) / (1 + u * u);
+    const Float psi = k == 0 ? d - a : sd / u;
+    U[k] = 2 / (b - a) * (psi - chi);
+    const Float next = cd * wr - sd * wi;
+    sd = cd * wi + sd * wr;
+    cd = next;
+  }
+  U[0] /= 2;
+}
+} // namespace impl
+
+/**
+ * prices European options on a whole vector of strikes by the COS method of Fang and Oosterlee,
+ * from the characteristic function of a model.
+ * <br/>
+ * The density of ln(S_T / K) is expanded in a cosine series over a range common to all strikes,
+ * L sqrt(c2 + sqrt(c4)) beyond the extreme log-moneyness, c2 and c4 being cumulants of the log-return, so that the characteristic function and
+ * the payoff coefficients are evaluated once for the chain, terms times each,
+ * and every strike only adds a rotation of the series, carried by complex multiplications.
+ * Puts are priced from the series, calls by put-call parity, which keeps the payoff coefficients bounded.
+ * The series converges exponentially for smooth densities such as those of GBM and Heston,
+ * and algebraically for variance gamma at short maturities.
+ *
+ * @tparam Float
+ * @tparam Model callable as std::complex<Float>(Float u, Float T),
+ *               characteristic function of ln(S_T / S_0) - (r - q) T, e.g. gbm, heston or variance_gamma
+ * @param model
+ * @param call true for calls, false for puts
+ * @param S underlying spot price
+ * @param K strike prices
+ * @param n number of strikes
+ * @param T time to maturity
+ * @param r risk-free interest rate
+ * @param q dividend paying rate of underlying
+ * @param price output, n prices
+ * @param terms number of terms of the cosine series
+ */
+template<typename Float, typename Model, typename = floating_guard<Float>>
+inline
+void
+cos_price(const Model &model, bool call, Float S, const Float *K, size_t n, Float T, Float r, Float q, Float *price,
+          size_t terms = CQF_COS_TERMS) {
+  if (n == 0) {
+    return;
+  }
+  using complex = std::complex<Float>;
+  const Float drift = (r - q) * T;
+  Float c1 = 0, c2 = 0, c4 = 0;
+  impl::cos_cumulants(model, T, drift, c1, c2, c4);
+  const Float width = CQF_COS_TRUNCATION * sqrt(c2 + sqrt(c4));
+
+  Float lo = ln(S / K[0]), hi = lo;
+  for (size_t j = 1; j < n; ++j) {
+    lo = min(lo, ln(S / K[j]));
+    hi = max(hi, ln(S / K[j]));
+  }
+  const Float a = lo + c1 - width;
+  const Float b = hi + c1 + width;
+
+  // A_k = phi(u_k) e^(-i u_k a) U_k, shared by every strike
+  std::vector<Float> U(terms);
+  impl::cos_put_coefficients(a, b, U.data(), terms);
+  std::vector<complex> A(terms);
+  const Float shift = constants<Float>::pi * (drift - a) / (b - a);
+  const complex rotation(cos(shift), sin(shift));
+  complex e(1, 0);
+  for (size_t k = 0; k < terms; ++k) {
+    const Float u = static_cast<Float>(k) * constants<Float>::pi / (b - a);
+    A[k] = model(u, T) * e * U[k];
+    e = complex(e.real() * rotation.real() - e.imag() * rotation.imag(),
+                e.real() * rotation.imag() + e.imag() * rotation.real());
+  }
+
+  // strikes are summed a block at a time, the block being the inner loop so that it vectorizes,
+  // e^(i u_k x_j) = w_j^k, w_j = e^(i pi x_j / (b - a)), rotated by hand
+  // since complex operator* checks for infinities on every product
+  constexpr size_t block = CQF_COS_BLOCK;
+  Float wr[block], wi[block], zr[block], zi[block], sum[block];
+  for (size_t begin = 0; begin < n; begin += block) {
+    const size_t size = min(block, n - begin);
+    for (size_t j = 0; j < size; ++j) {
+      const Float angle = constants<Float>::pi * ln(S / K[begin + j]) / (b - a);
+      wr[j] = cos(angle);
+      wi[j] = sin(angle);
+      zr[j] = 1;
+      zi[j] = 0;
+      sum[j] = 0;
+    }
+    for (size_t k = 0; k < terms; ++k) {
+      const Float ar = A[k].real(), ai = A[k].imag();
+      for (size_t j = 0; j < size; ++j) {
+        sum[j] += ar * zr[j] - ai * zi[j];
+        const Float next = zr[j] * wr[j] - zi[j] * wi[j];
+        zi[j] = zr[j] * wi[j] + zi[j] * wr[j];
+        zr[j] = next;
+      }
+    }
+    for (size_t j = 0; j < size; ++j) {
+      const Float KPV = K[begin + j] * exp(-r * T);
+      const Float put = KPV * sum[j];
+      price[begin + j] = call ? put + S * exp(-q * T) - KPV : put;
+    }
+  }
+}
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_COS_METHOD_H_
@@ -5,8 +5,42 @@
 #define CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_COUPON_BOND_H_
 
 #include "math/traits.h"
+#include "math/basic.h"
+#include "math/exp.h"
 
 namespace cqf {
+/**
+ * price and yield sensitivities of a bond evaluated at once.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct bond_analytics {
+  Float price;      // present value at yield to maturity
+  Float dv01;       // -dB / dY per basis point
+  Float duration;   // modified duration, (-1 / B) * (dB / dY)
+  Float convexity;  // (1 / B) * (d^2B / dY^2)
+};
+
+namespace impl {
+/**
+ * analytics of a bond from the sums of its discounted cash flows weighted by 1, t and t^2,
+ * that is B, -dB / dY and d^2B / dY^2.
+ *
+ * @tparam Float
+ * @param B
+ * @param dB
+ * @param d2B
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+bond_analytics<Float>
+bond_analytics_of(Float B, Float dB, Float d2B) noexcept {
+  return {B, dB / 10000, dB / B, d2B / B};
+}
+} // namespace impl
+
 /**
  * represents a coupon paying bond.
  * @tparam Float
@@ -60,6 +94,13 @@ class coupon_bond {
    */
   inline constexpr Float yield_to_maturity() const { return yield; };
 
+  /**
+   * time to maturity in years.
+   *
+   * @return
+   */
+  inline constexpr Float maturity() const { return T; };
+
   /**
    * fair price of bond's cash flows discounted at yield to maturity.
    *
@@ -96,6 +137,85 @@ class coupon_bond {
     return d2BdY2() / price();
   }
 
+  /**
+   * price, DV01, duration and convexity in a single pass over the cash flows,
+   * every discount factor being shared by the three sums,
+   * where price, duration and convexity each walk the schedule again.
+   *
+   * @return
+   */
+  inline constexpr
+  bond_analytics<Float>
+  analytics() const {
+    return analytics_impl([this](Float t) { return exp(-yield * t); });
+  }
+
+  /**
+   * price, DV01, duration and convexity with every cash flow discounted on a term structure
+   * rather than at the yield to maturity, the sensitivities being to a parallel shift
+   * of the continuously compounded zero rates.
+   *
+   * @tparam Curve term structure with Float discount(Float t) const, e.g. yield_curve
+   * @param curve
+   * @return
+   */
+  template<typename Curve>
+  inline constexpr
+  bond_analytics<Float>
+  analytics(const Curve &curve) const {
+    return analytics_impl([&curve](Float t) { return curve.discount(t); });
+  }
+
+  /**
+   * fair price of bond's cash flows discounted on a term structure.
+   *
+   * @tparam Curve term structure with Float discount(Float t) const, e.g. yield_curve
+   * @param curve
+   * @return
+   */
+  template<typename Curve>
+  inline constexpr
+  Float
+  price(const Curve &curve) const {
+    return analytics(curve).price;
+  }
+
+  /**
+   * number of payments still due, coupons and principal, the principal being paid with the last coupon.
+   *
+   * @return
+   */
+  inline constexpr
+  size_t
+  cash_flow_count() const {
+    size_t n = 1;
+    while (coupon_time(n - 1) >= limits<Float>::epsilon() * T) {
+      ++n;
+    }
+    return n;
+  }
+
+  /**
+   * writes the payment times and amounts in chronological order, the last one being the final coupon
+   * and the principal.
+   *
+   * @param times output, cash_flow_count() elements
+   * @param amounts output, cash_flow_count() elements
+   * @return number of cash flows written
+   */
+  inline constexpr
+  size_t
+  cash_flows(Float *times, Float *amounts) const {
+    const size_t n = cash_flow_count();
+    for (size_t k = 0; k + 1 < n; ++k) {
+      times[n - 2 - k] = coupon_time(k);
+      amounts[n - 2 - k] = CQF_DEFAULT_PAR_VALUE * (r / m);
+    }
+    times[n - 1] = T;
+    amounts[n - 1] = CQF_DEFAULT_PAR_VALUE * (100. + r / m);
+    return n;
+  }
+
  private:
   /**
    * present value of cash flows up until time t discounted at yield to maturity added with a value.
@@ -107,9 +227,7 @@ class coupon_bond {
   inline constexpr
   Float
   present_value_until_impl(Float acc, Float t) const {
-    return t < limits<Float>::epsilon() * T ? acc :
-           present_value_until_impl(acc + CQF_DEFAULT_PAR_VALUE * (r / m) * exp(-yield * t),
-                                    t - 1. / static_cast<Float>(m));
+    return coupons_until_impl(acc, t, 0);
   }
 
   /**
@@ -134,9 +252,7 @@ class coupon_bond {
   inline constexpr
   Float
   dBdY_until_impl(Float acc, Float t) const {
-    return t < limits<Float>::epsilon() * T ? acc :
-           dBdY_until_impl(acc - t * CQF_DEFAULT_PAR_VALUE * (r / m) * exp(-yield * t),
-                           t - 1. / static_cast<Float>(m));
+    return coupons_until_impl(acc, t, 1);
   }
 
   /**
@@ -161,9 +277,73 @@ class coupon_bond {
   inline constexpr
   Float
   d2BdY2_until_impl(Float acc, Float t) const {
-    return t < limits<Float>::epsilon() * T ? acc :
-           d2BdY2_until_impl(acc + t * t * CQF_DEFAULT_PAR_VALUE * (r / m) * exp(-yield * t),
-                             t - 1. / static_cast<Float>(m));
+    return coupons_until_impl(acc, t, 2);
+  }
+
+  /**
+   * sums of the cash flows discounted by a function of time, weighted by 1, t and t^2, in a single pass.
+   *
+   * @tparam Discount
+   * @param discount
+   * @return
+   */
+  template<typename Discount>
+  inline constexpr
+  bond_analytics<Float>
+  analytics_impl(const Discount &discount) const {
+    const Float coupon = CQF_DEFAULT_PAR_VALUE * (r / m);
+    compensated_sum<Float> B{}, dB{}, d2B{};
+    for (size_t k = 0; coupon_time(k) >= limits<Float>::epsilon() * T; ++k) {
+      const Float t = coupon_time(k);
+      const Float pv = coupon * discount(t);
+      B += pv;
+      dB += t * pv;
+      d2B += t * t * pv;
+    }
+    const Float pv = CQF_DEFAULT_PAR_VALUE * (100. + r / m) * discount(T);
+    B += pv;
+    dB += T * pv;
+    d2B += T * T * pv;
+    return impl::bond_analytics_of(B.value(), dB.value(), d2B.value());
+  }
+
+  /**
+   * time of the k-th coupon counted back from the last but one.
+   *
+   * @param k
+   * @return
+   */
+  inline constexpr
+  Float
+  coupon_time(size_t k) const {
+    return T - 1. / static_cast<Float>(m) - static_cast<Float>(k) / static_cast<Float>(m);
+  }
+
+  /**
+   * n-th derivative with respect to yield to maturity of the present value of the coupons paid
+   * at t, t - 1 / m, ... down to the earliest one after now, added with a value.
+   * payment times are computed from their index rather than by repeated decrements, so they do not drift,
+   * and the terms are added with compensation.
+   *
+   * @param acc
+   * @param t
+   * @param order 0, 1 or 2
+   * @return
+   */
+  inline constexpr
+  Float
+  coupons_until_impl(Float acc, Float t, int order) const {
+    const Float coupon = CQF_DEFAULT_PAR_VALUE * (r / m);
+    compensated_sum<Float> result{acc, 0};
+    for (size_t k = 0;; ++k) {
+      const Float tk = t - static_cast<Float>(k) / static_cast<Float>(m);
+      if (tk < limits<Float>::epsilon() * T) {
+        break;
+      }
+      const Float weight = order == 0 ? static_cast<Float>(1) : order == 1 ? -tk : tk * tk;
+      result += weight * coupon * exp(-yield * tk);
+    }
+    return result.value();
   }
 
  public:
@@ -0,0 +1,159 @@
+//
+// Created by mamin on 12/29/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_COUPON_BOND_BATCH_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_COUPON_BOND_BATCH_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "math/traits.h"
+#include "math/basic.h"
+#include "math/exp.h"
+#include "math/simd.h"
+#include "model/coupon_bond.h"
+
+namespace cqf {
+/**
+ * structure-of-arrays output of a batch evaluation of bonds.
+ * every array must be able to hold as many elements as the schedule it is paired with.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct bond_chain_analytics {
+  Float *price;      // present value at yield to maturity
+  Float *dv01;       // -dB / dY per basis point
+  Float *duration;   // modified duration
+  Float *convexity;  // (1 / B) * (d^2B / dY^2)
+};
+
+/**
+ * cash flows of many coupon bonds materialized once into flat arrays, for repeated evaluation at changing yields.
+ * <br/>
+ * The payments of every bond are stored one bond after the other, each tagged with the index of its bond,
+ * so that an evaluation is a single pass over contiguous times and amounts regardless of how
+ * the payments are spread among the bonds. Building the schedule allocates, evaluating it does not.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+class bond_schedule {
+ private:
+  std::vector<Float> times;     // payment times of every bond, one bond after the other
+  std::vector<Float> amounts;   // payment amounts
+  std::vector<size_t> owner;    // index of the bond of every payment
+  std::vector<Float> yields;    // yield to maturity of every bond
+
+ public:
+  bond_schedule() = default;
+
+  /**
+   * constructor.
+   *
+   * @param bonds
+   */
+  inline explicit
+  bond_schedule(const std::vector<coupon_bond<Float>> &bonds) {
+    yields.reserve(bonds.size());
+    for (const coupon_bond<Float> &bond : bonds) {
+      push_back(bond);
+    }
+  }
+
+  /**
+   * appends the cash flows of a bond.
+   *
+   * @param bond
+   */
+  inline
+  void
+  push_back(const coupon_bond<Float> &bond) {
+    const size_t begin = times.size(), n = bond.cash_flow_count();
+    times.resize(begin + n);
+    amounts.resize(begin + n);
+    bond.cash_flows(times.data() + begin, amounts.data() + begin);
+    owner.insert(owner.end(), n, yields.size());
+    yields.push_back(bond.yield_to_maturity());
+  }
+
+  /**
+   * number of bonds.
+   *
+   * @return
+   */
+  inline size_t size() const { return yields.size(); }
+
+  /**
+   * number of payments of all bonds.
+   *
+   * @return
+   */
+  inline size_t cash_flow_count() const { return times.size(); }
+
+  /**
+   * evaluates every bond at its own yield to maturity.
+   *
+   * @param out output arrays
+   */
+  inline
+  void
+  evaluate(const bond_chain_analytics<Float> &out) const noexcept {
+    evaluate(yields.data(), out);
+  }
+
+  /**
+   * evaluates every bond at the given yields, in a single fused pass over the payments.
+   * <br/>
+   * Payments are processed CQF_SIMD_BLOCK at a time: the discount factors of a block are computed together,
+   * by the vectorized exponential of simd.h in double precision, then every payment adds its
+   * present value, weighted by 1, t and t^2, to its bond. The output arrays serve as accumulators
+   * until the sums are turned into analytics bond by bond.
+   *
+   * @param yield yield to maturity of every bond
+   * @param out output arrays
+   */
+  inline
+  void
+  evaluate(const Float *yield, const bond_chain_analytics<Float> &out) const noexcept {
+    std::fill(out.price, out.price + size(), static_cast<Float>(0));
+    std::fill(out.dv01, out.dv01 + size(), static_cast<Float>(0));
+    std::fill(out.convexity, out.convexity + size(), static_cast<Float>(0));
+
+    Float discount[CQF_SIMD_BLOCK];
+    for (size_t begin = 0; begin < times.size(); begin += CQF_SIMD_BLOCK) {
+      const size_t n = min(static_cast<size_t>(CQF_SIMD_BLOCK), times.size() - begin);
+      const Float *t = times.data() + begin, *amount = amounts.data() + begin;
+      const size_t *bond = owner.data() + begin;
+      for (size_t j = 0; j < n; ++j) {
+        discount[j] = -yield[bond[j]] * t[j];
+      }
+      if constexpr (std::is_same_v<Float, double>) {
+        simd::exp(discount, discount, n);
+      } else {
+        for (size_t j = 0; j < n; ++j) {
+          discount[j] = exp(discount[j]);
+        }
+      }
+      for (size_t j = 0; j < n; ++j) {
+        const Float pv = amount[j] * discount[j];
+        out.price[bond[j]] += pv;
+        out.dv01[bond[j]] += t[j] * pv;
+        out.convexity[bond[j]] += t[j] * t[j] * pv;
+      }
+    }
+
+    for (size_t i = 0; i < size(); ++i) {
+      const bond_analytics<Float> a = impl::bond_analytics_of(out.price[i], out.dv01[i], out.convexity[i]);
+      out.price[i] = a.price;
+      out.dv01[i] = a.dv01;
+      out.duration[i] = a.duration;
+      out.convexity[i] = a.convexity;
+    }
+  }
+};
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_COUPON_BOND_BATCH_H_
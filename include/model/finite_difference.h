@@ -0,0 +1,318 @@
+//
+// Created by mamin on 12/27/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_FINITE_DIFFERENCE_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_FINITE_DIFFERENCE_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "math/traits.h"
+#include "math/basic.h"
+#include "math/exp.h"
+#include "math/log.h"
+#include "math/sqrt.h"
+#include "model/black_scholes_batch.h"
+#include "engine/thread_pool.h"
+
+namespace cqf {
+/**
+ * discretization settings of the finite-difference engine.
+ */
+struct fd_settings {
+  size_t space = CQF_FD_SPACE_STEPS;  // intervals of the spot grid
+  size_t time = CQF_FD_TIME_STEPS;    // Crank-Nicolson steps to maturity, tau_k = T (k / time)^2
+  size_t rannacher = 2;               // leading Crank-Nicolson steps replaced by two implicit half-steps each
+  bool american = true;               // early exercise, European otherwise
+};
+
+/**
+ * value and the sensitivities read off the grid of the finite-difference engine.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct fd_result {
+  Float premium;  // value of option
+  Float delta;    // dV / dS
+  Float gamma;    // d^2V / dS^2
+  Float theta;    // dV / dt
+};
+
+namespace impl {
+/**
+ * LU factorization of the tridiagonal matrix lower[i] x[i-1] + diag[i] x[i] + upper[i] x[i+1] by Thomas' algorithm,
+ * eliminating from the top of the grid down if top_down, from the bottom up otherwise.
+ * the factors only depend on the matrix, so that a time-stepping scheme with constant coefficients
+ * factors once and every step is left with two passes of multiply-adds, free of divisions.
+ *
+ * @tparam Float
+ * @param lower sub-diagonal, lower[0] unused
+ * @param diag diagonal
+ * @param upper super-diagonal, upper[n - 1] unused
+ * @param ratio output, off-diagonal towards the yet uneliminated neighbour over the pivot
+ * @param pivot output, reciprocal pivots
+ * @param n
+ * @param top_down
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static
+void
+tridiagonal_factor(const Float *lower, const Float *diag, const Float *upper, Float *ratio, Float *pivot, size_t n,
+                   bool top_down) noexcept {
+  // eliminates in order first, first + step, ..., the coefficient towards the eliminated neighbour being before
+  const size_t first = top_down ? n - 1 : 0;
+  const ptrdiff_t step = top_down ? -1 : 1;
+  const Float *before = top_down ? upper : lower, *after = top_down ? lower : upper;
+
+  pivot[first] = 1 / diag[first];
+  ratio[first] = after[first] * pivot[first];
+  for (size_t k = 1; k < n; ++k) {
+    const size_t i = first + step * static_cast<ptrdiff_t>(k), previous = i - step;
+    pivot[i] = 1 / (diag[i] - before[i] * ratio[previous]);
+    ratio[i] = after[i] * pivot[i];
+  }
+}
+
+/**
+ * solves a factored tridiagonal system, optionally projecting the solution onto x >= exercise
+ * as in Brennan and Schwartz.
+ * <br/>
+ * The elimination runs away from the early exercise region and the back substitution towards it,
+ * taking the larger of continuation and exercise value at every node. This solves the linear complementarity
+ * problem of an American option exactly, in a single pass, whenever the exercise region is one connected end
+ * of the grid, low spots for puts and high spots for calls.
+ * All arrays are walked sequentially in a single direction per pass.
+ *
+ * @tparam Float
+ * @param lower sub-diagonal of the factored matrix
+ * @param upper super-diagonal of the factored matrix
+ * @param ratio from tridiagonal_factor
+ * @param pivot from tridiagonal_factor
+ * @param rhs right-hand side
+ * @param exercise value of immediate exercise, null for a plain linear solve
+ * @param x output solution
+ * @param n
+ * @param top_down as factored, true if the exercise region is at the low end of the grid
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static
+void
+brennan_schwartz(const Float *lower, const Float *upper, const Float *ratio, const Float *pivot, const Float *rhs,
+                 const Float *exercise, Float *x, size_t n, bool top_down) noexcept {
+  const size_t first = top_down ? n - 1 : 0;
+  const ptrdiff_t step = top_down ? -1 : 1;
+  const Float *before = top_down ? upper : lower;
+
+  x[first] = rhs[first] * pivot[first];
+  for (size_t k = 1; k < n; ++k) {
+    const size_t i = first + step * static_cast<ptrdiff_t>(k);
+    x[i] = (rhs[i] - before[i] * x[i - step]) * pivot[i];
+  }
+
+  const size_t last = first + step * static_cast<ptrdiff_t>(n - 1);
+  x[last] = exercise ? max(x[last], exercise[last]) : x[last];
+  for (size_t k = n - 1; k-- > 0;) {
+    const size_t i = first + step * static_cast<ptrdiff_t>(k);
+    x[i] -= ratio[i] * x[i + step];
+    x[i] = exercise ? max(x[i], exercise[i]) : x[i];
+  }
+}
+
+/**
+ * solves the tridiagonal system lower[i] x[i-1] + diag[i] x[i] + upper[i] x[i+1] = rhs[i] by Thomas' algorithm.
+ *
+ * @tparam Float
+ * @param lower
+ * @param diag
+ * @param upper
+ * @param rhs
+ * @param x output solution
+ * @param ratio scratch of n elements
+ * @param pivot scratch of n elements
+ * @param n
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static
+void
+thomas(const Float *lower, const Float *diag, const Float *upper, const Float *rhs, Float *x,
+       Float *ratio, Float *pivot, size_t n) noexcept {
+  tridiagonal_factor(lower, diag, upper, ratio, pivot, n, false);
+  brennan_schwartz(lower, upper, ratio, pivot, rhs, static_cast<const Float *>(nullptr), x, n, false);
+}
+
+/**
+ * spot grid S_i = K + alpha sinh(xi_i) from 0 to about S_max, xi_i evenly spaced,
+ * alpha = CQF_FD_CONCENTRATION width, so that nodes concentrate around the strike where the payoff has its kink.
+ * the spacing in xi is adjusted for the strike to fall on a node, which keeps the kink from
+ * contributing a first order error.
+ *
+ * @tparam Float
+ * @param K
+ * @param width scale of the concentration, one standard deviation of the spot at maturity
+ * @param upper S_max
+ * @param grid output, intervals + 1 nodes
+ * @param intervals
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static
+void
+fd_grid(Float K, Float width, Float upper, Float *grid, size_t intervals) noexcept {
+  const Float alpha = static_cast<Float>(CQF_FD_CONCENTRATION) * width;
+  const auto asinh = [](Float x) { return ln(x + sqrt(x * x + 1)); };
+  const Float lo = asinh(-K / alpha), hi = asinh((upper - K) / alpha);
+  const size_t below = min(max(static_cast<size_t>(round(intervals * lo / (lo - hi))), static_cast<size_t>(1)),
+                           intervals - 1);
+  const Float step = -lo / static_cast<Float>(below);
+  for (size_t i = 0; i <= intervals; ++i) {
+    const Float xi = lo + step * static_cast<Float>(i);
+    grid[i] = K + alpha * (exp(xi) - exp(-xi)) / 2;
+  }
+  grid[0] = 0;
+  grid[below] = K;
+}
+
+/**
+ * value, first and second derivative at x of the quadratic through (x0, y0), (x1, y1) and (x2, y2).
+ *
+ * @tparam Float
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+fd_result<Float>
+fd_quadratic(Float x, Float x0, Float x1, Float x2, Float y0, Float y1, Float y2) noexcept {
+  const Float d01 = (y1 - y0) / (x1 - x0), d12 = (y2 - y1) / (x2 - x1);
+  const Float d012 = (d12 - d01) / (x2 - x0);
+  return {y0 + (x - x0) * (d01 + (x - x1) * d012), d01 + (2 * x - x0 - x1) * d012, 2 * d012, 0};
+}
+} // namespace impl
+
+/**
+ * prices a plain vanilla option, American by default, by Crank-Nicolson finite differences
+ * on the Black-Scholes equation dV/dtau = sigma^2 S^2 / 2 V_SS + (r - q) S V_S - r V.
+ * <br/>
+ * The spot grid is non-uniform, concentrated around the strike, and reaches CQF_FD_BOUND standard deviations
+ * above the larger of spot and strike. Time steps are quadratically spaced, tau_k = T (k / N)^2, fine close to
+ * maturity where the early exercise boundary moves as sqrt(tau), which restores second order convergence
+ * to American options. The first steps are replaced by implicit Euler half-steps,
+ * Rannacher's smoothing, which damps the oscillations the payoff kink would otherwise cause in delta and gamma.
+ * Early exercise is enforced by the Brennan-Schwartz projection within the tridiagonal solve,
+ * so every step costs the factorization of its matrix and two sequential passes over the grid.
+ * Delta and gamma are read off the grid around the spot, and theta from the equation itself.
+ *
+ * @tparam Float
+ * @param call true for calls, false for puts
+ * @param S underlying spot price
+ * @param K strike price
+ * @param T time to maturity
+ * @param r risk-free interest rate
+ * @param q dividend paying rate of underlying
+ * @param sigma volatility
+ * @param settings
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static
+fd_result<Float>
+finite_difference(bool call, Float S, Float K, Float T, Float r, Float q, Float sigma,
+                  const fd_settings &settings = {}) {
+  const size_t m = max(settings.space, static_cast<size_t>(4)), n = m + 1;
+  const size_t steps = max(settings.time, static_cast<size_t>(1));
+  const Float omega = call ? 1 : -1;
+  const Float upper = max(S, K) * exp(static_cast<Float>(CQF_FD_BOUND) * sigma * sqrt(T));
+
+  std::vector<Float> grid(n), exercise(n), l(n), d(n), u(n), a(n), b(n), c(n), rhs(n), v(n);
+  std::vector<Float> ratio(n), pivot(n);
+  impl::fd_grid(K, K * sigma * sqrt(T), upper, grid.data(), m);
+  for (size_t i = 0; i < n; ++i) {
+    exercise[i] = max(omega * (grid[i] - K), static_cast<Float>(0));
+    v[i] = exercise[i];
+  }
+  // spatial operator L V_i = l_i V_{i-1} + d_i V_i + u_i V_{i+1} on the non-uniform grid
+  for (size_t i = 1; i < m; ++i) {
+    const Float hl = grid[i] - grid[i - 1], hu = grid[i + 1] - grid[i];
+    const Float diffusion = sigma * sigma * grid[i] * grid[i] / 2, drift = (r - q) * grid[i];
+    l[i] = (2 * diffusion - drift * hu) / (hl * (hl + hu));
+    u[i] = (2 * diffusion + drift * hl) / (hu * (hl + hu));
+    d[i] = -l[i] - u[i] - r;
+  }
+
+  // (I - theta dt L) V' = (I + (1 - theta) dt L) V, the boundary rows holding Dirichlet values,
+  // the matrix being factored at every step since theta dt changes with the quadratic spacing
+  const auto march = [&](Float tau, Float dt, Float theta) {
+    for (size_t i = 1; i < m; ++i) {
+      a[i] = -theta * dt * l[i];
+      b[i] = 1 - theta * dt * d[i];
+      c[i] = -theta * dt * u[i];
+    }
+    b[0] = b[m] = 1;
+    c[0] = a[m] = 0;
+    impl::tridiagonal_factor(a.data(), b.data(), c.data(), ratio.data(), pivot.data(), n, !call);
+    const Float explicit_dt = (1 - theta) * dt;
+    for (size_t i = 1; i < m; ++i) {
+      rhs[i] = v[i] + explicit_dt * (l[i] * v[i - 1] + d[i] * v[i] + u[i] * v[i + 1]);
+    }
+    const Float low = call ? static_cast<Float>(0) : K * exp(-r * tau);
+    const Float high = call ? grid[m] * exp(-q * tau) - K * exp(-r * tau) : static_cast<Float>(0);
+    rhs[0] = settings.american ? max(low, exercise[0]) : low;
+    rhs[m] = settings.american ? max(high, exercise[m]) : high;
+    impl::brennan_schwartz(a.data(), c.data(), ratio.data(), pivot.data(), rhs.data(),
+                           settings.american ? exercise.data() : nullptr, v.data(), n, !call);
+  };
+
+  Float tau = 0;
+  for (size_t k = 0; k < steps; ++k) {
+    const Float x = static_cast<Float>(k + 1) / static_cast<Float>(steps);
+    const Float next = T * x * x;
+    const Float dt = next - tau;
+    if (k < settings.rannacher) {
+      march(tau + dt / 2, dt / 2, 1);
+      march(next, dt / 2, 1);
+    } else {
+      march(next, dt, static_cast<Float>(0.5));
+    }
+    tau = next;
+  }
+
+  // quadratic through the three nodes closest to the spot
+  size_t i = 1;
+  while (i < m - 1 && grid[i] < S) {
+    ++i;
+  }
+  i = i > 1 && S - grid[i - 1] < grid[i] - S ? i - 1 : i;
+  fd_result<Float> result = impl::fd_quadratic(S, grid[i - 1], grid[i], grid[i + 1], v[i - 1], v[i], v[i + 1]);
+  // theta = -L V off the exercise region, where the option is worth its payoff and does not decay
+  const bool exercised = settings.american && result.premium <= max(omega * (S - K), static_cast<Float>(0));
+  result.theta = exercised ? static_cast<Float>(0) :
+                 r * result.premium - (r - q) * S * result.delta - sigma * sigma * S * S / 2 * result.gamma;
+  return result;
+}
+
+/**
+ * prices a whole chain of plain vanilla options by finite_difference, one option per task of the pool.
+ * the premium, delta, gamma and theta arrays of the output are written, vega and rho are left untouched.
+ *
+ * @tparam Float
+ * @param in input chain
+ * @param out output arrays
+ * @param pool
+ * @param settings
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static
+void
+finite_difference_chain(const vanilla_chain<Float> &in, const vanilla_chain_greeks<Float> &out, thread_pool &pool,
+                        const fd_settings &settings = {}) {
+  pool.parallel_for(in.size, [&](size_t i) {
+    const fd_result<Float> result =
+        finite_difference(in.call[i], in.S[i], in.K[i], in.T[i], in.r[i], in.q[i], in.sigma[i], settings);
+    out.premium[i] = result.premium;
+    out.delta[i] = result.delta;
+    out.gamma[i] = result.gamma;
+    out.theta[i] = result.theta;
+  });
+}
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_FINITE_DIFFERENCE_H_
@@ -0,0 +1,148 @@
+//
+// Created by mamin on 12/20/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_IMPLIED_VOLATILITY_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_IMPLIED_VOLATILITY_H_
+
+#include <cstddef>
+
+#include "math/traits.h"
+#include "math/basic.h"
+#include "math/constants.h"
+#include "math/exp.h"
+#include "math/log.h"
+#include "math/sqrt.h"
+#include "math/norm.h"
+
+namespace cqf {
+namespace impl {
+/**
+ * normalized Black call price
+ * b(x, s) = e^(x/2) N(x/s + s/2) - e^(-x/2) N(x/s - s/2),
+ * which is the undiscounted call price divided by sqrt(F K).
+ *
+ * @tparam Float
+ * @param x log-moneyness ln(F / K)
+ * @param s total volatility sigma * sqrt(T)
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+Float
+normalized_black(Float x, Float s) noexcept {
+  return exp(x / 2) * norm_cdf(x / s + s / 2) - exp(-x / 2) * norm_cdf(x / s - s / 2);
+}
+
+/**
+ * derivative of the normalized Black call price with respect to total volatility.
+ * db / ds = exp(-(x^2 / s^2 + s^2 / 4) / 2) / sqrt(2 pi)
+ *
+ * @tparam Float
+ * @param x
+ * @param s
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+Float
+normalized_vega(Float x, Float s) noexcept {
+  return exp(-(x * x / (s * s) + s * s / 4) / 2) / sqrt(constants<Float>::_2pi);
+}
+
+/**
+ * inverts the normalized Black call price for an out-of-the-money option.
+ * <br/>
+ * The iteration starts from the Corrado-Miller approximation,
+ * or from the inflection point s = sqrt(2|x|) of b wherever the approximation breaks down,
+ * and applies third-order Householder updates, which only need b and db / ds,
+ * since the higher derivatives of b are db / ds times polynomials of x and s.
+ * Below the inflection point, b is convex and exponentially small,
+ * and the iteration is carried out on ln b instead.
+ * Every evaluation tightens a bracket around the root, and an update leaving the bracket is replaced by bisection.
+ *
+ * @tparam Float
+ * @param x log-moneyness, non-positive
+ * @param beta normalized price, 0 < beta < e^(x/2)
+ * @return total volatility sigma * sqrt(T)
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+Float
+implied_total_volatility(Float x, Float beta) noexcept {
+  const Float sc = sqrt(2 * abs(x));
+  const bool lower = beta < normalized_black(x, sc);
+
+  // Corrado-Miller, in normalized terms
+  const Float forward = exp(x / 2), strike = exp(-x / 2);
+  const Float c = beta - (forward - strike) / 2;
+  const Float radicand = c * c - (forward - strike) * (forward - strike) / constants<Float>::pi;
+  Float s = radicand >= 0 ? sqrt(constants<Float>::_2pi) / (forward + strike) * (c + sqrt(radicand)) : sc;
+  s = s > 0 ? s : sc;
+
+  Float lo = 0, hi = limits<Float>::infinity();
+  for (size_t i = 0; i < CQF_IMPLIED_MAX_ITERATIONS; ++i) {
+    // b = forward N(d1) - strike N(d2), whose rounding error scales with the first term rather than with b
+    const Float forward_term = forward * norm_cdf(x / s + s / 2);
+    const Float b = forward_term - strike * norm_cdf(x / s - s / 2);
+    if (abs(b - beta) <= CQF_IMPLIED_ERROR_SCALE * limits<Float>::epsilon() * forward_term) {
+      return s;
+    }
+    const Float vega = normalized_vega(x, s);
+    if (b > beta) { hi = min(hi, s); } else { lo = max(lo, s); }
+
+    // f'' / f' and f''' / f' of f = b - beta
+    Float h2 = x * x / (s * s * s) - s / 4;
+    Float h3 = h2 * h2 - 3 * x * x / (s * s * s * s) - static_cast<Float>(0.25);
+    Float newton = -(b - beta) / vega;
+    if (lower) {
+      // the same for f = ln b - ln beta
+      const Float nu = vega / b;
+      h3 = h3 - 3 * nu * h2 + 2 * nu * nu;
+      h2 = h2 - nu;
+      newton = -(ln(b) - ln(beta)) / nu;
+    }
+    const Float next = s + newton * (1 + h2 * newton / 2) / (1 + newton * (h2 + h3 * newton / 6));
+    if (abs(next - s) <= CQF_IMPLIED_ERROR_SCALE * limits<Float>::epsilon() * s) {
+      return next;
+    }
+    s = next > lo && next < hi ? next :
+        hi < limits<Float>::infinity() ? (lo + hi) / 2 :
+        2 * s;
+  }
+  return s;
+}
+} // namespace impl
+
+/**
+ * implied volatility of a European plain vanilla option from its traded price.
+ * <br/>
+ * The price is normalized by the discounted geometric mean of forward and strike,
+ * and in-the-money options are mapped to their out-of-the-money counterparts through put-call parity.
+ * Prices below intrinsic value or above the upper no-arbitrage bound have no implied volatility.
+ *
+ * @tparam Float
+ * @param call true for calls, false for puts
+ * @param S underlying spot price
+ * @param K strike price
+ * @param T time to maturity
+ * @param r risk-free interest rate
+ * @param q dividend paying rate of underlying
+ * @param price traded price of option
+ * @return implied volatility, 0 at intrinsic value, nan if out of the no-arbitrage bounds
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+Float
+implied_volatility(bool call, Float S, Float K, Float T, Float r, Float q, Float price) noexcept {
+  const Float F = S * exp((r - q) * T);
+  const Float x = ln(F / K);
+  const Float intrinsic = max((call ? 1 : -1) * (exp(x / 2) - exp(-x / 2)), static_cast<Float>(0));
+  const Float beta = price / (exp(-r * T) * sqrt(F * K)) - intrinsic;
+  return nan(beta) ? beta :
+         beta == 0 ? static_cast<Float>(0) :
+         beta < 0 or beta >= exp(-abs(x) / 2) ? limits<Float>::quiet_NaN() :
+         impl::implied_total_volatility(-abs(x), beta) / sqrt(T);
+}
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_IMPLIED_VOLATILITY_H_
@@ -0,0 +1,337 @@
+//
+// Created by mamin on 12/28/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_LATTICE_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_LATTICE_H_
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "math/traits.h"
+#include "math/basic.h"
+#include "math/exp.h"
+#include "math/log.h"
+#include "math/power.h"
+#include "math/simd.h"
+#include "math/sqrt.h"
+
+namespace cqf {
+/**
+ * recombining trees of the lattice engine.
+ */
+enum class lattice_tree {
+  crr,            // binomial of Cox, Ross and Rubinstein, first order and oscillating in the number of steps
+  leisen_reimer,  // binomial of Leisen and Reimer, centered on the strike, second order for European options
+  trinomial       // trinomial of Boyle in Hull's parametrization, first order
+};
+
+/**
+ * discretization and exercise settings of the lattice engine.
+ */
+struct lattice_settings {
+  size_t steps = CQF_LATTICE_STEPS;                 // time steps to maturity, rounded up to odd by Leisen-Reimer
+  lattice_tree tree = lattice_tree::leisen_reimer;  // kind of tree
+  bool american = true;                             // exercise at every step
+  size_t bermudan = 0;                              // otherwise, evenly spaced exercise dates up to maturity
+  bool richardson = true;                           // Leisen-Reimer extrapolated from the tree of about half the steps
+};
+
+/**
+ * value and the sensitivities read off the first nodes of a lattice.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct lattice_result {
+  Float premium;  // value of option
+  Float delta;    // dV / dS
+  Float gamma;    // d^2V / dS^2
+};
+
+namespace impl {
+/**
+ * Peizer-Pratt inversion of the normal distribution, method 2, giving the binomial probability
+ * that matches N(z) on an n-step tree.
+ *
+ * @tparam Float
+ * @param z
+ * @param n odd number of steps
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+Float
+peizer_pratt(Float z, size_t n) noexcept {
+  const Float steps = static_cast<Float>(n);
+  const Float x = z / (steps + static_cast<Float>(1) / 3 + static_cast<Float>(0.1) / (steps + 1));
+  const Float half = sqrt(1 - exp(-x * x * (steps + static_cast<Float>(1) / 6))) / 2;
+  return z < 0 ? static_cast<Float>(0.5) - half : static_cast<Float>(0.5) + half;
+}
+
+/**
+ * whether step i of an n-step tree is the first step at or past one of the exercise dates,
+ * every step if american, the dates k T / bermudan for k = 1, ..., bermudan otherwise.
+ *
+ * @param i
+ * @param n
+ * @param settings
+ * @return
+ */
+inline static constexpr
+bool
+lattice_exercisable(size_t i, size_t n, const lattice_settings &settings) noexcept {
+  return settings.american || (i > 0 && settings.bermudan > 0 && i * settings.bermudan / n != (i - 1) * settings.bermudan / n);
+}
+
+/**
+ * value, first and second derivative at x of the quadratic through three nodes of a lattice.
+ *
+ * @tparam Float
+ * @param x
+ * @param s spots of the nodes
+ * @param v values of the nodes
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static constexpr
+lattice_result<Float>
+lattice_quadratic(Float x, const Float *s, const Float *v) noexcept {
+  const Float d01 = (v[1] - v[0]) / (s[1] - s[0]), d12 = (v[2] - v[1]) / (s[2] - s[1]);
+  const Float d012 = (d12 - d01) / (s[2] - s[0]);
+  return {v[0] + (x - s[0]) * (d01 + (x - s[1]) * d012), d01 + (2 * x - s[0] - s[1]) * d012, 2 * d012};
+}
+
+/**
+ * one step of backward induction, v[j] = sum_k weight[k] v[j + k] for j = 0, ..., n - 1,
+ * every spot being moved back by a factor, and the value floored at the exercise value if exercise.
+ * <br/>
+ * The values are overwritten in place, node j + k being read before it is written, so that the loop
+ * runs a vector register of nodes at a time, the leftover nodes and other floating point types element by element.
+ *
+ * @tparam Width number of successors of a node, 2 for binomial trees and 3 for trinomial trees
+ * @tparam Float
+ * @param v values of the next step, output values of this step
+ * @param s spots of the next step, output spots of this step
+ * @param n nodes of this step
+ * @param weight discounted probabilities of the successors, lowest first
+ * @param back factor moving the spot of a node back by a step
+ * @param omega +1 for calls, -1 for puts
+ * @param K
+ * @param exercise
+ */
+template<size_t Width, typename Float, typename = floating_guard<Float>>
+inline static
+void
+lattice_step(Float *v, Float *s, size_t n, const Float *weight, Float back, Float omega, Float K,
+             bool exercise) noexcept {
+  size_t j = 0;
+  if constexpr (std::is_same_v<Float, double> || std::is_same_v<Float, float>) {
+    constexpr size_t lanes = CQF_SIMD_BYTES / sizeof(Float);
+    using V = simd::batch<Float, lanes>;
+    for (; j + lanes <= n; j += lanes) {
+      V value{}, next, spot;
+      for (size_t k = 0; k < Width; ++k) {
+        std::memcpy(&next, v + j + k, sizeof(V));
+        value += weight[k] * next;
+      }
+      std::memcpy(&spot, s + j, sizeof(V));
+      spot *= back;
+      if (exercise) {
+        const V payoff = omega * (spot - K);
+        value = value >= payoff ? value : payoff;
+      }
+      std::memcpy(s + j, &spot, sizeof(V));
+      std::memcpy(v + j, &value, sizeof(V));
+    }
+  }
+  for (; j < n; ++j) {
+    Float value = 0;
+    for (size_t k = 0; k < Width; ++k) {
+      value += weight[k] * v[j + k];
+    }
+    s[j] *= back;
+    v[j] = exercise ? max(value, omega * (s[j] - K)) : value;
+  }
+}
+
+/**
+ * backward induction on an n-step binomial tree of up and down factors u and d,
+ * with p the probability of the up move.
+ * <br/>
+ * Values and spots of a single time step live in two arrays of n + 1 elements that are overwritten
+ * in place from maturity to the root, node j of step i being reached by j up moves out of i.
+ * Every step is a single pass of lattice_step over contiguous elements.
+ * Delta is read off the two nodes of the first step and gamma off the three nodes of the second.
+ *
+ * @tparam Float
+ * @param omega +1 for calls, -1 for puts
+ * @param S
+ * @param K
+ * @param u up factor
+ * @param d down factor
+ * @param p probability of the up move
+ * @param discount discount factor over one step
+ * @param n
+ * @param settings
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static
+lattice_result<Float>
+binomial(Float omega, Float S, Float K, Float u, Float d, Float p, Float discount, size_t n,
+         const lattice_settings &settings) {
+  std::vector<Float> value(n + 1), spot(n + 1);
+  spot[0] = S * power(d, n);
+  for (size_t j = 1; j <= n; ++j) {
+    spot[j] = spot[j - 1] * u / d;
+  }
+  for (size_t j = 0; j <= n; ++j) {
+    value[j] = max(omega * (spot[j] - K), static_cast<Float>(0));
+  }
+
+  const Float weight[2] = {discount * (1 - p), discount * p}, back = 1 / d;
+  Float *v = value.data(), *s = spot.data();
+  Float delta = 0;
+  lattice_result<Float> second{};
+  for (size_t i = n; i-- > 0;) {
+    lattice_step<2>(v, s, i + 1, weight, back, omega, K, lattice_exercisable(i, n, settings));
+    if (i == 2) {
+      second = lattice_quadratic(S, s, v);
+    } else if (i == 1) {
+      delta = (v[1] - v[0]) / (s[1] - s[0]);
+    }
+  }
+  return {v[0], delta, second.gamma};
+}
+
+/**
+ * backward induction on an n-step trinomial tree of spacing u, with pu and pd the probabilities
+ * of the up and down moves.
+ * node j of step i is the spot S u^(j - i), j = 0, ..., 2i, so that values and spots fit in two arrays
+ * of 2n + 1 elements overwritten in place as by binomial. Delta and gamma are read off the three nodes of the first step.
+ *
+ * @tparam Float
+ * @param omega +1 for calls, -1 for puts
+ * @param S
+ * @param K
+ * @param u
+ * @param pu
+ * @param pd
+ * @param discount discount factor over one step
+ * @param n
+ * @param settings
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static
+lattice_result<Float>
+trinomial(Float omega, Float S, Float K, Float u, Float pu, Float pd, Float discount, size_t n,
+          const lattice_settings &settings) {
+  std::vector<Float> value(2 * n + 1), spot(2 * n + 1);
+  spot[n] = S;
+  for (size_t j = n; j-- > 0;) {
+    spot[j] = spot[j + 1] / u;
+  }
+  for (size_t j = n + 1; j <= 2 * n; ++j) {
+    spot[j] = spot[j - 1] * u;
+  }
+  for (size_t j = 0; j <= 2 * n; ++j) {
+    value[j] = max(omega * (spot[j] - K), static_cast<Float>(0));
+  }
+
+  const Float weight[3] = {discount * pd, discount * (1 - pu - pd), discount * pu};
+  Float *v = value.data(), *s = spot.data();
+  lattice_result<Float> first{};
+  for (size_t i = n; i-- > 0;) {
+    lattice_step<3>(v, s, 2 * i + 1, weight, u, omega, K, lattice_exercisable(i, n, settings));
+    if (i == 1) {
+      first = lattice_quadratic(S, s, v);
+    }
+  }
+  return {v[0], first.delta, first.gamma};
+}
+
+/**
+ * one tree of the lattice engine with n steps.
+ *
+ * @tparam Float
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static
+lattice_result<Float>
+lattice_tree_value(bool call, Float S, Float K, Float T, Float r, Float q, Float sigma, size_t n,
+                   const lattice_settings &settings) {
+  const Float omega = call ? 1 : -1;
+  const Float dt = T / static_cast<Float>(n);
+  const Float discount = exp(-r * dt), growth = exp((r - q) * dt);
+  switch (settings.tree) {
+    case lattice_tree::crr: {
+      const Float u = exp(sigma * sqrt(dt)), d = 1 / u;
+      return binomial(omega, S, K, u, d, (growth - d) / (u - d), discount, n, settings);
+    }
+    case lattice_tree::leisen_reimer: {
+      const Float vol = sigma * sqrt(T);
+      const Float d1 = (ln(S / K) + (r - q + sigma * sigma / 2) * T) / vol, d2 = d1 - vol;
+      const Float p = peizer_pratt(d2, n), p_prime = peizer_pratt(d1, n);
+      const Float u = growth * p_prime / p, d = (growth - p * u) / (1 - p);
+      return binomial(omega, S, K, u, d, p, discount, n, settings);
+    }
+    case lattice_tree::trinomial:
+    default: {
+      const Float half = exp(sigma * sqrt(dt / 2)), drift = exp((r - q) * dt / 2);
+      const Float pu = (drift - 1 / half) / (half - 1 / half), pd = (half - drift) / (half - 1 / half);
+      return trinomial(omega, S, K, half * half, pu * pu, pd * pd, discount, n, settings);
+    }
+  }
+}
+} // namespace impl
+
+/**
+ * prices a plain vanilla option, American by default, on a recombining binomial or trinomial tree
+ * from the parameters of vanilla.
+ * <br/>
+ * Memory is linear in the number of steps, a single step of the tree being kept and rolled back in place.
+ * Leisen-Reimer trees are built on an odd number of steps, centered so that the strike falls between two nodes
+ * at maturity, and converge smoothly, at second order for European options and first order with early exercise:
+ * 200 steps of a European option are more accurate than 2000 of Cox-Ross-Rubinstein.
+ * With richardson, a Leisen-Reimer tree is priced again with about half the steps, m, and the two values
+ * are extrapolated as (n^p V_n - m^p V_m) / (n^p - m^p), p being that order of convergence.
+ * Cox-Ross-Rubinstein and trinomial trees oscillate with the position of the strike among the nodes,
+ * which defeats extrapolation, and are left as they are.
+ * Bermudan options exercise at the first step at or past each of bermudan evenly spaced dates, maturity included.
+ *
+ * @tparam Float
+ * @param call true for calls, false for puts
+ * @param S underlying spot price
+ * @param K strike price
+ * @param T time to maturity
+ * @param r risk-free interest rate
+ * @param q dividend paying rate of underlying
+ * @param sigma volatility
+ * @param settings
+ * @return
+ */
+template<typename Float, typename = floating_guard<Float>>
+inline static
+lattice_result<Float>
+lattice(bool call, Float S, Float K, Float T, Float r, Float q, Float sigma, const lattice_settings &settings = {}) {
+  const bool odd = settings.tree == lattice_tree::leisen_reimer;
+  const size_t n = max(settings.steps, static_cast<size_t>(4)) | (odd ? 1 : 0);
+  const lattice_result<Float> fine = impl::lattice_tree_value(call, S, K, T, r, q, sigma, n, settings);
+  if (!settings.richardson || !odd) {
+    return fine;
+  }
+  const size_t m = n / 2 | 1;
+  const lattice_result<Float> coarse = impl::lattice_tree_value(call, S, K, T, r, q, sigma, m, settings);
+  const int order = settings.american || settings.bermudan > 0 ? 1 : 2;
+  const Float wn = power(static_cast<Float>(n), order), wm = power(static_cast<Float>(m), order);
+  const auto extrapolate = [&](Float vn, Float vm) { return (wn * vn - wm * vm) / (wn - wm); };
+  return {extrapolate(fine.premium, coarse.premium), extrapolate(fine.delta, coarse.delta),
+          extrapolate(fine.gamma, coarse.gamma)};
+}
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_LATTICE_H_
@@ -0,0 +1,281 @@
+//
+// Created by mamin on 12/23/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_MONTE_CARLO_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_MONTE_CARLO_H_
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "math/traits.h"
+#include "math/basic.h"
+#include "math/exp.h"
+#include "math/log.h"
+#include "math/sqrt.h"
+#include "math/simd.h"
+#include "math/philox.h"
+#include "math/sobol.h"
+#include "model/black_scholes.h"
+#include "model/brownian_bridge.h"
+#include "engine/thread_pool.h"
+
+namespace cqf {
+/**
+ * payoff of a European plain vanilla option, mostly useful to validate the engine against closed forms.
+ * every payoff is evaluated on a path of steps + 1 prices, path[0] being the spot and path[steps] the terminal price.
+ *
+ * @tparam Float
+ * @tparam Side
+ */
+template<typename Float, option_side Side, typename = floating_guard<Float>>
+struct european {
+  Float K;  // strike
+
+  inline constexpr
+  Float
+  operator()(const Float *path, size_t steps) const noexcept {
+    return max((Side == option_side::call ? 1 : -1) * (path[steps] - K), static_cast<Float>(0));
+  }
+};
+
+/**
+ * payoff of an arithmetic average price Asian option, averaging over the monitoring dates path[1..steps].
+ *
+ * @tparam Float
+ * @tparam Side
+ */
+template<typename Float, option_side Side, typename = floating_guard<Float>>
+struct asian {
+  Float K;  // strike
+
+  inline constexpr
+  Float
+  operator()(const Float *path, size_t steps) const noexcept {
+    Float average = 0;
+    for (size_t i = 1; i <= steps; ++i) {
+      average += path[i];
+    }
+    average /= static_cast<Float>(steps);
+    return max((Side == option_side::call ? 1 : -1) * (average - K), static_cast<Float>(0));
+  }
+};
+
+enum class barrier_type { up_and_out, up_and_in, down_and_out, down_and_in };
+
+/**
+ * payoff of a discretely monitored knock-out or knock-in option, the barrier being checked at every path point.
+ *
+ * @tparam Float
+ * @tparam Side
+ */
+template<typename Float, option_side Side, typename = floating_guard<Float>>
+struct barrier {
+  Float K;            // strike
+  Float B;            // barrier level
+  barrier_type type;
+
+  inline constexpr
+  Float
+  operator()(const Float *path, size_t steps) const noexcept {
+    const bool up = type == barrier_type::up_and_out || type == barrier_type::up_and_in;
+    const bool in = type == barrier_type::up_and_in || type == barrier_type::down_and_in;
+    bool hit = false;
+    for (size_t i = 0; i <= steps && !hit; ++i) {
+      hit = up ? path[i] >= B : path[i] <= B;
+    }
+    return hit == in ? max((Side == option_side::call ? 1 : -1) * (path[steps] - K), static_cast<Float>(0))
+                     : static_cast<Float>(0);
+  }
+};
+
+/**
+ * payoff of a floating strike lookback option, S_T - min S for calls and max S - S_T for puts.
+ *
+ * @tparam Float
+ * @tparam Side
+ */
+template<typename Float, option_side Side, typename = floating_guard<Float>>
+struct lookback {
+  inline constexpr
+  Float
+  operator()(const Float *path, size_t steps) const noexcept {
+    Float extreme = path[0];
+    for (size_t i = 1; i <= steps; ++i) {
+      extreme = Side == option_side::call ? min(extreme, path[i]) : max(extreme, path[i]);
+    }
+    return (Side == option_side::call ? 1 : -1) * (path[steps] - extreme);
+  }
+};
+
+/**
+ * simulation settings of the Monte Carlo engine.
+ */
+struct mc_settings {
+  size_t paths = 65536;         // number of samples, antithetic pairs counting as one sample
+  size_t steps = 64;            // monitoring dates, evenly spaced up to maturity
+  uint64_t seed = 0;            // key of the random number generator
+  bool antithetic = true;       // pairs every path with its reflection -z
+  double control_strike = 0;    // strike of the European call used as control variate, none if not positive
+  bool quasi = false;           // Sobol points through a Brownian bridge instead of pseudo-random draws
+};
+
+/**
+ * Monte Carlo estimate along with its standard error.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct mc_result {
+  Float price;
+  Float error;      // standard error of the estimate
+  size_t paths;     // number of simulated paths
+};
+
+namespace impl {
+/**
+ * running sums of payoff samples y and control samples x.
+ */
+struct mc_moments {
+  double n, y, x, yy, xx, xy;
+
+  inline constexpr
+  mc_moments &
+  operator+=(const mc_moments &other) noexcept {
+    n += other.n;
+    y += other.y;
+    x += other.x;
+    yy += other.yy;
+    xx += other.xx;
+    xy += other.xy;
+    return *this;
+  }
+};
+
+/**
+ * builds a geometric Brownian motion path from normal draws, exactly in distribution at the monitoring dates.
+ *
+ * @param z normal draws, one per step
+ * @param sign 1, or -1 for the antithetic path
+ * @param S spot
+ * @param drift (r - q - sigma^2 / 2) dt
+ * @param diffusion sigma sqrt(dt)
+ * @param path output, steps + 1 prices
+ * @param steps
+ */
+inline static
+void
+gbm_path(const double *z, double sign, double S, double drift, double diffusion, double *path, size_t steps) noexcept {
+  double x = 0;
+  path[0] = 0;
+  for (size_t i = 0; i < steps; ++i) {
+    x += drift + sign * diffusion * z[i];
+    path[i + 1] = x;
+  }
+  simd::exp(path, path, steps + 1);
+  for (size_t i = 0; i <= steps; ++i) {
+    path[i] *= S;
+  }
+}
+} // namespace impl
+
+/**
+ * prices a path-dependent payoff under geometric Brownian motion, the dynamics of vanilla, by Monte Carlo.
+ * <br/>
+ * Samples are cut into chunks of CQF_MC_CHUNK, simulated in parallel on the pool.
+ * Sample i draws its normals from its own Philox stream i, and the moments of every chunk are summed in chunk order,
+ * so that a seed gives the same estimate to the last bit on any number of threads.
+ * With antithetic variates a sample is the average of a path and its reflection.
+ * With a control variate, the discounted call payoff on the same paths is regressed out,
+ * its expectation being the closed-form call_vanilla premium, and the regression coefficient being estimated
+ * from the same samples.
+ * <br/>
+ * Quasi Monte Carlo draws sample i from Sobol point i + 1, skipping the origin, and builds the path by Brownian bridge,
+ * steps beyond sobol_dimensions being padded with the pseudo-random draws of the sample.
+ * The reported error is then the pseudo-random standard error, an upper estimate of the actual error.
+ * <br/>
+ * Without any path to average, settings.paths being 0, the price and its error are nan.
+ *
+ * @tparam Payoff callable as payoff(const double *path, size_t steps)
+ * @param payoff
+ * @param S underlying spot price
+ * @param T time to maturity
+ * @param r risk-free interest rate
+ * @param q dividend paying rate of underlying
+ * @param sigma volatility
+ * @param settings
+ * @param pool
+ * @return discounted expected payoff and its standard error
+ */
+template<typename Payoff>
+inline static
+mc_result<double>
+monte_carlo(const Payoff &payoff, double S, double T, double r, double q, double sigma,
+            const mc_settings &settings, thread_pool &pool) {
+  if (settings.paths == 0) {
+    return {limits<double>::quiet_NaN(), limits<double>::quiet_NaN(), 0};
+  }
+  const size_t steps = max(settings.steps, static_cast<size_t>(1));
+  const double dt = T / static_cast<double>(steps);
+  const double drift = (r - q - sigma * sigma / 2) * dt, diffusion = sigma * sqrt(dt);
+  const double discount = exp(-r * T);
+  const bool control = settings.control_strike > 0;
+  const philox rng(settings.seed);
+  const brownian_bridge bridge(settings.quasi ? steps : 0);
+  const size_t quasi = settings.quasi ? min(steps, sobol_dimensions) : 0;
+
+  std::vector<impl::mc_moments> partials((settings.paths + CQF_MC_CHUNK - 1) / CQF_MC_CHUNK);
+  pool.parallel_for(partials.size(), [&](size_t chunk) {
+    std::vector<double> z(steps), w(settings.quasi ? steps : 0), path(steps + 1);
+    double u[sobol_dimensions];
+    sobol<sobol_dimensions> sequence(chunk * CQF_MC_CHUNK + 1);
+    impl::mc_moments m{};
+    const size_t end = min((chunk + 1) * CQF_MC_CHUNK, settings.paths);
+    for (size_t i = chunk * CQF_MC_CHUNK; i < end; ++i) {
+      if (quasi < steps) {
+        normal_fill(rng, i, z.data(), steps);
+      }
+      if (settings.quasi) {
+        sequence.next(u);
+        simd::norm_ppf(u, w.data(), quasi);
+        std::copy(z.begin() + quasi, z.end(), w.begin() + quasi);
+        bridge.transform(w.data(), z.data());
+      }
+      double y = 0, x = 0;
+      for (double sign : {1., -1.}) {
+        impl::gbm_path(z.data(), sign, S, drift, diffusion, path.data(), steps);
+        y += discount * payoff(path.data(), steps);
+        x += control ? discount * max(path[steps] - settings.control_strike, 0.) : 0.;
+        if (!settings.antithetic) {
+          break;
+        }
+      }
+      if (settings.antithetic) {
+        y /= 2;
+        x /= 2;
+      }
+      m += {1., y, x, y * y, x * x, x * y};
+    }
+    partials[chunk] = m;
+  });
+
+  impl::mc_moments m{};
+  for (const auto &partial : partials) {
+    m += partial;
+  }
+  const double n = m.n;
+  const double y = m.y / n, syy = m.yy / n - y * y;
+  double price = y, variance = syy;
+  if (control) {
+    const double x = m.x / n, sxx = m.xx / n - x * x, sxy = m.xy / n - x * y;
+    const double beta = sxx > 0 ? sxy / sxx : 0.;
+    const double expected = call_vanilla<double>(S, settings.control_strike, T, r, q, sigma).premium();
+    price = y - beta * (x - expected);
+    variance = syy - beta * sxy;
+  }
+  return {price, sqrt(max(variance, 0.) / (n > 1 ? n - 1 : 1)), (settings.antithetic ? 2 : 1) * settings.paths};
+}
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_MONTE_CARLO_H_
@@ -0,0 +1,368 @@
+//
+// Created by mamin on 12/30/2020.
+//
+#ifndef CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_YIELD_CURVE_H_
+#define CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_YIELD_CURVE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "math/traits.h"
+#include "math/basic.h"
+#include "math/exp.h"
+#include "math/log.h"
+#include "math/simd.h"
+#include "model/coupon_bond.h"
+
+namespace cqf {
+/**
+ * kinds of instruments a yield curve is bootstrapped from.
+ */
+enum class curve_instrument_kind {
+  deposit,  // zero coupon, simple interest
+  swap,     // par swap, fixed leg paid m times per annum against a floating leg worth par
+  bond      // coupon bond at a traded price
+};
+
+/**
+ * market quote of an instrument of a yield curve.
+ * the constructors are not meant to be called directly, see deposit, swap and bond.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+struct curve_instrument {
+  curve_instrument_kind kind;
+  Float T;      // maturity in years
+  Float rate;   // deposit or swap rate, 0.03 for 3%, or coupon rate of a bond in percentage, 3 for 3%
+  Float price;  // traded price of a bond per 100 of face value
+  int m;        // coupon payments per annum of swaps and bonds
+
+  /**
+   * deposit paying 1 + rate T at T for 1 today.
+   *
+   * @param T
+   * @param rate
+   * @return
+   */
+  inline static constexpr
+  curve_instrument
+  deposit(Float T, Float rate) noexcept {
+    return {curve_instrument_kind::deposit, T, rate, 0, 1};
+  }
+
+  /**
+   * par swap, whose fixed leg of rate / m per period, with the notional at T, is worth the notional today.
+   *
+   * @param T
+   * @param rate
+   * @param m
+   * @return
+   */
+  inline static constexpr
+  curve_instrument
+  swap(Float T, Float rate, int m = 2) noexcept {
+    return {curve_instrument_kind::swap, T, rate, 0, m};
+  }
+
+  /**
+   * coupon bond laid out as coupon_bond, at a traded price.
+   *
+   * @param T
+   * @param coupon coupon rate in percentage
+   * @param price per 100 of face value
+   * @param m
+   * @return
+   */
+  inline static constexpr
+  curve_instrument
+  bond(Float T, Float coupon, Float price, int m = 2) noexcept {
+    return {curve_instrument_kind::bond, T, coupon, price, m};
+  }
+};
+
+/**
+ * term structure of interest rates, log-linear in discount factors between knots,
+ * that is with piecewise flat instantaneous forward rates, and flat forward beyond the last knot.
+ * <br/>
+ * Knots are kept as times, logarithms of discount factors and the forward rate of the segment after each,
+ * so that a discount factor costs one exponential. Segments are found in constant time through a table
+ * splitting [0, last knot] into CQF_CURVE_CELLS cells per knot, each holding the segment its left end falls in,
+ * from which at most a few knots remain to be skipped.
+ * Bootstrapping fits one knot per instrument at its maturity, in order of maturity, every knot being
+ * solved by Newton's method on its log discount factor with the knots before it fixed,
+ * since the log-linear interpolation of a segment only depends on its two ends. The payments of an instrument
+ * falling on the fitted part of the curve are discounted together, by the vectorized exponential in double precision.
+ * Rebuilding a curve in place reuses its storage.
+ *
+ * @tparam Float
+ */
+template<typename Float, typename = floating_guard<Float>>
+class yield_curve {
+ private:
+  std::vector<Float> times;          // knots, the first one at 0
+  std::vector<Float> log_discount;   // ln P at the knots
+  std::vector<Float> forward;        // forward rate of the segment after each knot, the last one extrapolated
+  std::vector<uint32_t> cells;       // segment of the left end of every cell
+  Float cell_scale = 0;              // cells per year
+
+  std::vector<size_t> order;         // bootstrapping scratch: instruments by maturity
+  std::vector<Float> flow_times;     // bootstrapping scratch: cash flows of an instrument
+  std::vector<Float> flow_amounts;
+  std::vector<Float> flow_discount;
+
+  /**
+   * forward rates of the segments and the lookup table, once the knots are in place.
+   */
+  inline
+  void
+  index() {
+    const size_t n = times.size();
+    forward.resize(n);
+    for (size_t i = 0; i + 1 < n; ++i) {
+      forward[i] = (log_discount[i] - log_discount[i + 1]) / (times[i + 1] - times[i]);
+    }
+    forward[n - 1] = n > 1 ? forward[n - 2] : static_cast<Float>(0);
+
+    cells.resize(CQF_CURVE_CELLS * n);
+    cell_scale = n > 1 ? static_cast<Float>(cells.size()) / times[n - 1] : static_cast<Float>(0);
+    uint32_t segment = 0;
+    for (size_t c = 0; c < cells.size(); ++c) {
+      const Float left = static_cast<Float>(c) / cell_scale;
+      while (segment + 2 < n && times[segment + 1] <= left) {
+        ++segment;
+      }
+      cells[c] = segment;
+    }
+  }
+
+  /**
+   * segment containing t, the last knot for t beyond it.
+   *
+   * @param t
+   * @return
+   */
+  inline
+  size_t
+  segment(Float t) const noexcept {
+    const size_t c = static_cast<size_t>(max(t, static_cast<Float>(0)) * cell_scale);
+    if (c >= cells.size()) {
+      return times.size() - 1;
+    }
+    size_t i = cells[c];
+    while (i + 2 < times.size() && times[i + 1] < t) {
+      ++i;
+    }
+    return i;
+  }
+
+ public:
+  /**
+   * flat curve of continuously compounded zero rate.
+   *
+   * @param rate
+   */
+  inline explicit
+  yield_curve(Float rate = 0) : times{0, 1}, log_discount{0, -rate} {
+    index();
+  }
+
+  /**
+   * curve through the given discount factors.
+   *
+   * @param t increasing positive times
+   * @param discount discount factors at t
+   * @param n number of knots
+   */
+  inline
+  yield_curve(const Float *t, const Float *discount, size_t n) : times{0}, log_discount{0} {
+    for (size_t i = 0; i < n; ++i) {
+      times.push_back(t[i]);
+      log_discount.push_back(ln(discount[i]));
+    }
+    index();
+  }
+
+  /**
+   * curve bootstrapped from market quotes.
+   *
+   * @param instruments
+   * @param n
+   */
+  inline
+  yield_curve(const curve_instrument<Float> *instruments, size_t n) {
+    bootstrap(instruments, n);
+  }
+
+  /**
+   * rebuilds the curve in place from market quotes, one knot at the maturity of every instrument.
+   * the curve reprices every instrument exactly. Instruments may come in any order,
+   * but no two may share a maturity: the knot would be over-determined, and the curve turns into nan from there on.
+   *
+   * @param instruments
+   * @param n
+   */
+  inline
+  void
+  bootstrap(const curve_instrument<Float> *instruments, size_t n) {
+    order.resize(n);
+    std::iota(order.begin(), order.end(), static_cast<size_t>(0));
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return instruments[a].T < instruments[b].T; });
+    times.assign(1, 0);
+    log_discount.assign(1, 0);
+    forward.clear();
+    Float last_forward = 0;
+
+    for (const size_t k : order) {
+      const curve_instrument<Float> &instrument = instruments[k];
+      const Float t0 = times.back(), x0 = log_discount.back(), T = instrument.T;
+
+      // cash flows and the value they must discount to
+      size_t flows = 1;
+      Float target = 1;
+      if (instrument.kind == curve_instrument_kind::deposit) {
+        flow_times.resize(1);
+        flow_amounts.resize(1);
+        flow_discount.resize(1);
+        flow_times[0] = T;
+        flow_amounts[0] = 1 + instrument.rate * T;
+      } else {
+        const bool swap = instrument.kind == curve_instrument_kind::swap;
+        const coupon_bond<Float> bond(T, swap ? 100 * instrument.rate : instrument.rate, 0,
+                                      static_cast<int8_t>(instrument.m));
+        flows = bond.cash_flow_count();
+        flow_times.resize(flows);
+        flow_amounts.resize(flows);
+        flow_discount.resize(flows);
+        bond.cash_flows(flow_times.data(), flow_amounts.data());
+        target = swap ? 100 * CQF_DEFAULT_PAR_VALUE : instrument.price;
+      }
+
+      // payments up to the last knot are discounted on the curve so far, walking its segments from the one
+      // of the first payment up to the one ending at t0, a payment on t0 itself included,
+      // the others on the new segment, ln P(t) = (1 - w) x0 + w x, w = (t - t0) / (T - t0)
+      size_t first = 0;
+      if (times.size() > 1) {
+        size_t i = static_cast<size_t>(std::upper_bound(times.begin(), times.end(), flow_times[0]) - times.begin());
+        i = min(i > 0 ? i - 1 : 0, times.size() - 2);
+        while (first < flows && flow_times[first] <= t0) {
+          while (i + 2 < times.size() && times[i + 1] < flow_times[first]) {
+            ++i;
+          }
+          flow_discount[first] = log_discount[i] - forward[i] * (flow_times[first] - times[i]);
+          ++first;
+        }
+      }
+      if constexpr (std::is_same_v<Float, double>) {
+        simd::exp(flow_discount.data(), flow_discount.data(), first);
+      } else {
+        for (size_t j = 0; j < first; ++j) {
+          flow_discount[j] = exp(flow_discount[j]);
+        }
+      }
+      Float known = 0;
+      for (size_t j = 0; j < first; ++j) {
+        known += flow_amounts[j] * flow_discount[j];
+      }
+      Float x = x0 - last_forward * (T - t0);
+      for (size_t iteration = 0; iteration < CQF_CURVE_MAX_ITERATIONS; ++iteration) {
+        Float value = known - target, slope = 0;
+        for (size_t j = first; j < flows; ++j) {
+          const Float w = (flow_times[j] - t0) / (T - t0);
+          const Float pv = flow_amounts[j] * exp(x0 + w * (x - x0));
+          value += pv;
+          slope += w * pv;
+        }
+        const Float dx = value / slope;
+        x -= dx;
+        if (abs(dx) <= CQF_CURVE_ERROR_SCALE * limits<Float>::epsilon() * max(abs(x), static_cast<Float>(1))) {
+          break;
+        }
+      }
+      x = T > t0 ? x : limits<Float>::quiet_NaN();
+      times.push_back(T);
+      log_discount.push_back(x);
+      last_forward = (x0 - x) / (T - t0);
+      forward.push_back(last_forward);
+    }
+    index();
+  }
+
+  /**
+   * discount factor P(0, t).
+   *
+   * @param t
+   * @return
+   */
+  inline
+  Float
+  discount(Float t) const noexcept {
+    const size_t i = segment(t);
+    return exp(log_discount[i] - forward[i] * (t - times[i]));
+  }
+
+  /**
+   * continuously compounded zero rate to t, -ln P(0, t) / t, the short rate at t = 0.
+   *
+   * @param t
+   * @return
+   */
+  inline
+  Float
+  zero_rate(Float t) const noexcept {
+    const size_t i = segment(t);
+    return t > 0 ? (forward[i] * (t - times[i]) - log_discount[i]) / t : forward[0];
+  }
+
+  /**
+   * instantaneous forward rate at t.
+   *
+   * @param t
+   * @return
+   */
+  inline
+  Float
+  forward_rate(Float t) const noexcept {
+    return forward[segment(t)];
+  }
+
+  /**
+   * segment of t and the weight of its right end in the interpolation of the curve,
+   * ln P(0, t) = (1 - w) ln P(0, t_i) + w ln P(0, t_i+1), w exceeding 1 beyond the last knot,
+   * where the forward rate of the last segment is extrapolated. The curve must have a knot besides 0.
+   *
+   * @param t
+   * @param w output weight of knot i + 1
+   * @return i
+   */
+  inline
+  size_t
+  interpolation(Float t, Float &w) const noexcept {
+    const size_t i = min(segment(t), times.size() - 2);
+    w = (t - times[i]) / (times[i + 1] - times[i]);
+    return i;
+  }
+
+  /**
+   * time of a knot.
+   *
+   * @param i less than size, knot 0 being today
+   * @return
+   */
+  inline Float knot(size_t i) const { return times[i]; }
+
+  /**
+   * number of knots, the one at 0 included.
+   *
+   * @return
+   */
+  inline size_t size() const { return times.size(); }
+
+};
+} // namespace cqf
+
+#endif //CONSTEXPR_QUANTITATIVE_INCLUDE_MODEL_YIELD_CURVE_H_
@@ -3,8 +3,13 @@
 #pragma clang diagnostic ignored "-Wunknown-pragmas"
 #pragma ide diagnostic ignored "cert-err58-cpp"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
 #include <iostream>
+#include <memory>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include "math/traits.h"
@@ -17,10 +22,28 @@
 #include "math/trig.h"
 #include "math/gcd.h"
 #include "math/norm.h"
+#include "math/norm_table.h"
 #include "math/integral.h"
+#include "math/gauss.h"
+#include "math/simd.h"
+#include "math/philox.h"
+#include "math/sobol.h"
+#include "math/aad.h"
+#include "math/dual.h"
 
 #include "model/black_scholes.h"
 #include "model/coupon_bond.h"
+#include "model/coupon_bond_batch.h"
+#include "model/yield_curve.h"
+#include "model/cos_method.h"
+#include "model/finite_difference.h"
+#include "model/lattice.h"
+#include "model/black_scholes_batch.h"
+#include "engine/thread_pool.h"
+#include "engine/portfolio.h"
+#include "engine/revaluation.h"
+#include "model/monte_carlo.h"
+#include "model/brownian_bridge.h"
 
 class TestSuite :
     public ::testing::Test {
@@ -34,7 +57,7 @@ class TestSuite :
 };
 
 TEST_F(TestSuite, main) {
-  constexpr cqf::put_vanilla option(100.0, 100.0, 1., 0.05, 0.0, 0.3);
+  constexpr cqf::put_vanilla<double> option(100.0, 100.0, 1., 0.05, 0.0, 0.3);
   std::function<double(double)> func = [](double x) { return exp(-x * x / 2); };
   std::cout << std::setprecision(15) << cqf::integrate(func, -100., 100.) << std::endl;
   std::cout << std::setprecision(15) << cqf::sqrt(2 * cqf::constants<double>::pi) << std::endl;
@@ -46,4 +69,1108 @@ TEST_F(TestSuite, coupon) {
   std::cout << bond.duration() << std::endl;
   std::cout << bond.convexity() << std::endl;
 }
-#pragma clang diagnostic pop
\ No newline at end of file
+TEST_F(TestSuite, chain) {
+  const size_t n = 10000;
+  std::vector<double> S(n, 100.), K(n), T(n), r(n, 0.05), q(n, 0.02), sigma(n);
+  std::unique_ptr<bool[]> call(new bool[n]);
+  for (size_t i = 0; i < n; ++i) {
+    K[i] = 50. + 100. * static_cast<double>(i) / n;
+    T[i] = 0.1 + static_cast<double>(i % 20) / 10.;
+    sigma[i] = 0.1 + static_cast<double>(i % 7) / 20.;
+    call[i] = i % 2 == 0;
+  }
+  std::vector<double> premium(n), delta(n), gamma(n), vega(n), theta(n), rho(n);
+  cqf::vanilla_chain<double> in{S.data(), K.data(), T.data(), r.data(), q.data(), sigma.data(), call.get(), n};
+  cqf::vanilla_chain_greeks<double> out{premium.data(), delta.data(), gamma.data(), vega.data(), theta.data(), rho.data()};
+
+  auto start = std::chrono::steady_clock::now();
+  cqf::price_chain(in, out);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "contracts/second: " << static_cast<double>(n) / elapsed.count() << std::endl;
+
+  for (size_t i = 0; i < n; i += 97) {
+    if (call[i]) {
+      cqf::call_vanilla<double> option(S[i], K[i], T[i], r[i], q[i], sigma[i]);
+      EXPECT_NEAR(premium[i], option.premium(), 1e-9);
+      EXPECT_NEAR(delta[i], option.delta(), 1e-9);
+      EXPECT_NEAR(theta[i], option.theta(), 1e-9);
+      EXPECT_NEAR(rho[i], option.rho(), 1e-9);
+      EXPECT_NEAR(gamma[i], option.gamma(), 1e-9);
+      EXPECT_NEAR(vega[i], option.vega(), 1e-9);
+    } else {
+      cqf::put_vanilla<double> option(S[i], K[i], T[i], r[i], q[i], sigma[i]);
+      EXPECT_NEAR(premium[i], option.premium(), 1e-9);
+      EXPECT_NEAR(delta[i], option.delta(), 1e-9);
+      EXPECT_NEAR(theta[i], option.theta(), 1e-9);
+      EXPECT_NEAR(rho[i], option.rho(), 1e-9);
+      EXPECT_NEAR(gamma[i], option.gamma(), 1e-9);
+      EXPECT_NEAR(vega[i], option.vega(), 1e-9);
+    }
+  }
+
+  // deep out of the money, where N(d) is far below 1e-8 and the batch keeps the relative precision of norm_cdf
+  double S_otm[] = {100., 100., 100., 100.}, K_otm[] = {40., 250., 20., 400.}, T_otm[] = {0.25, 0.25, 0.25, 0.25};
+  double r_otm[] = {0.05, 0.05, 0.05, 0.05}, q_otm[] = {0.02, 0.02, 0.02, 0.02}, sigma_otm[] = {0.2, 0.2, 0.2, 0.2};
+  bool call_otm[] = {false, true, false, true};
+  cqf::price_chain(cqf::vanilla_chain<double>{S_otm, K_otm, T_otm, r_otm, q_otm, sigma_otm, call_otm, 4}, out);
+  for (size_t i = 0; i < 4; ++i) {
+    const cqf::greeks<double> reference = call_otm[i]
+        ? cqf::call_vanilla<double>(100., K_otm[i], 0.25, 0.05, 0.02, 0.2).evaluate()
+        : cqf::put_vanilla<double>(100., K_otm[i], 0.25, 0.05, 0.02, 0.2).evaluate();
+    EXPECT_GT(std::abs(premium[i]), 0.);
+    EXPECT_NEAR(premium[i], reference.premium, 1e-12 * std::abs(reference.premium));
+    EXPECT_NEAR(delta[i], reference.delta, 1e-12 * std::abs(reference.delta));
+    EXPECT_NEAR(rho[i], reference.rho, 1e-12 * std::abs(reference.rho));
+  }
+}
+TEST_F(TestSuite, simd) {
+  const size_t n = 1001;
+  std::vector<double> x(n), y(n);
+  for (auto set : {cqf::simd::isa::sse2, cqf::simd::isa::avx2, cqf::simd::isa::avx512}) {
+    if (!cqf::simd::supported(set)) continue;
+    cqf::simd::select(set);
+
+    for (size_t i = 0; i < n; ++i) x[i] = -740. + 1450. * static_cast<double>(i) / n;
+    cqf::simd::exp(x.data(), y.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_NEAR(y[i], std::exp(x[i]), 4e-16 * std::exp(x[i]));
+
+    for (size_t i = 0; i < n; ++i) x[i] = std::exp(-700. + 1400. * static_cast<double>(i) / n);
+    cqf::simd::ln(x.data(), y.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_NEAR(y[i], std::log(x[i]), 4e-16 * std::abs(std::log(x[i])));
+
+    for (size_t i = 0; i < n; ++i) x[i] = -7. + 14. * static_cast<double>(i) / n;
+    cqf::simd::erf(x.data(), y.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_NEAR(y[i], std::erf(x[i]), 4e-16 * std::abs(std::erf(x[i])));
+
+    for (size_t i = 0; i < n; ++i) x[i] = -7. + 33. * static_cast<double>(i) / n;
+    cqf::simd::erfc(x.data(), y.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_NEAR(y[i], std::erfc(x[i]), 8e-16 * std::erfc(x[i]));
+
+    for (size_t i = 0; i < n; ++i) x[i] = 1e3 * static_cast<double>(i) / n;
+    cqf::simd::sqrt(x.data(), y.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_DOUBLE_EQ(y[i], std::sqrt(x[i]));
+
+    for (size_t i = 0; i < n; ++i) x[i] = static_cast<double>(i) / (n - 1);
+    x[1] = 1e-300;
+    cqf::simd::norm_ppf(x.data(), y.data(), n);
+    for (size_t i = 1; i < n - 1; ++i) EXPECT_NEAR(y[i], cqf::norm_ppf(x[i]), 8e-16 * std::abs(cqf::norm_ppf(x[i])));
+    EXPECT_EQ(y[0], -cqf::limits<double>::infinity());
+    EXPECT_EQ(y[n - 1], cqf::limits<double>::infinity());
+  }
+  cqf::simd::select(cqf::simd::isa::avx512);
+
+  cqf::simd::batch<double, 4> v = {0., -1., 1e-310, cqf::limits<double>::infinity()};
+  v = cqf::simd::exp(cqf::simd::ln(v));
+  EXPECT_EQ(v[0], 0.);
+  EXPECT_TRUE(std::isnan(v[1]));
+  EXPECT_NEAR(v[2], 1e-310, 1e-320);
+  EXPECT_EQ(v[3], cqf::limits<double>::infinity());
+}
+TEST_F(TestSuite, dispatch) {
+  // compile-time evaluations take the recursive implementations, runtime ones the standard library
+  constexpr double e = cqf::exp(1.5), l = cqf::ln(7.), r = cqf::sqrt(3.), f = cqf::erf(0.7);
+  volatile double x = 1.5, y = 7., z = 3., w = 0.7;
+  EXPECT_NEAR(e, cqf::exp(x), 1e-14 * e);
+  EXPECT_NEAR(l, cqf::ln(y), 1e-14 * l);
+  EXPECT_NEAR(r, cqf::sqrt(z), 1e-14 * r);
+  EXPECT_NEAR(f, cqf::erf(w), 1e-14 * f);
+  EXPECT_EQ(cqf::exp(x), std::exp(1.5));
+  EXPECT_EQ(cqf::ln(y), std::log(7.));
+}
+TEST_F(TestSuite, implied) {
+  constexpr cqf::call_vanilla<double> call = cqf::call_vanilla<double>::implied(100., 110., 0.5, 0.03, 0.01, 4.2);
+  static_assert(call.implied_volatility() > 0.);
+  EXPECT_NEAR(call.premium(), 4.2, 1e-12);
+
+  // recovers the volatility over a wide range of moneyness, maturity and volatility
+  for (double k : {-3., -1., -0.2, 0., 0.2, 1., 3.}) {
+    for (double T : {0.01, 0.5, 5.}) {
+      for (double sigma : {0.05, 0.3, 1., 2.}) {
+        const double K = 100. * std::exp(k * sigma * std::sqrt(T));
+        cqf::call_vanilla<double> c(100., K, T, 0.05, 0.02, sigma);
+        cqf::put_vanilla<double> p(100., K, T, 0.05, 0.02, sigma);
+        EXPECT_NEAR(cqf::call_vanilla<double>::implied(100., K, T, 0.05, 0.02, c.premium()).implied_volatility(),
+                    sigma, 1e-7 * sigma) << "K=" << K << " T=" << T;
+        EXPECT_NEAR(cqf::put_vanilla<double>::implied(100., K, T, 0.05, 0.02, p.premium()).implied_volatility(),
+                    sigma, 1e-7 * sigma) << "K=" << K << " T=" << T;
+      }
+    }
+  }
+
+  // no-arbitrage bounds
+  EXPECT_TRUE(std::isnan(cqf::implied_volatility(true, 100., 90., 1., 0., 0., 9.)));
+  EXPECT_TRUE(std::isnan(cqf::implied_volatility(true, 100., 90., 1., 0., 0., 101.)));
+  EXPECT_EQ(cqf::implied_volatility(false, 100., 90., 1., 0., 0., 0.), 0.);
+
+  // whole chain
+  const size_t n = 1000;
+  std::vector<double> S(n, 100.), K(n), T(n, 0.25), r(n, 0.01), q(n, 0.), sigma(n), price(n), implied(n);
+  std::unique_ptr<bool[]> is_call(new bool[n]);
+  for (size_t i = 0; i < n; ++i) {
+    K[i] = 60. + 80. * static_cast<double>(i) / n;
+    sigma[i] = 0.2 + 0.1 * std::abs(K[i] - 100.) / 40.;
+    is_call[i] = K[i] > 100.;
+    price[i] = is_call[i] ? cqf::call_vanilla<double>(S[i], K[i], T[i], r[i], q[i], sigma[i]).premium()
+                          : cqf::put_vanilla<double>(S[i], K[i], T[i], r[i], q[i], sigma[i]).premium();
+  }
+  cqf::vanilla_chain<double> chain{S.data(), K.data(), T.data(), r.data(), q.data(), nullptr, is_call.get(), n};
+  auto start = std::chrono::steady_clock::now();
+  cqf::implied_chain(chain, price.data(), implied.data());
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "implied volatilities/second: " << static_cast<double>(n) / elapsed.count() << std::endl;
+  for (size_t i = 0; i < n; ++i) EXPECT_NEAR(implied[i], sigma[i], 1e-8 * sigma[i]);
+}
+TEST_F(TestSuite, erfc) {
+  // evaluated at compile time over the right tail, where 1 - erf(x) would cancel
+  constexpr auto tail = [] {
+    std::array<double, 121> y{};
+    for (size_t i = 0; i < y.size(); ++i) {
+      y[i] = cqf::erfc(2. + static_cast<double>(i) / 20.);
+    }
+    return y;
+  }();
+  for (size_t i = 0; i < tail.size(); ++i) {
+    const double x = 2. + static_cast<double>(i) / 20.;
+    EXPECT_NEAR(tail[i], std::erfc(x), 1e-15 * std::erfc(x)) << "x=" << x;
+  }
+  constexpr double left = cqf::erfc(-3.), erf = cqf::erf(2.5);
+  EXPECT_NEAR(left, std::erfc(-3.), 1e-15);
+  EXPECT_NEAR(erf, std::erf(2.5), 1e-15);
+
+  // and the tail of the tabulated distribution
+  EXPECT_NEAR(cqf::norm_cdf_table(-6.), 0.5 * std::erfc(6. / std::sqrt(2.)), 1e-15 * std::erfc(6. / std::sqrt(2.)));
+}
+TEST_F(TestSuite, evaluate) {
+  constexpr cqf::greeks<double> g = cqf::call_vanilla<double>(100., 95., 0.75, 0.04, 0.01, 0.25).evaluate();
+  static_assert(g.premium > 0.);
+
+  for (double K : {80., 100., 120.}) {
+    const double S = 100., T = 0.75, r = 0.04, q = 0.01, sigma = 0.25, h = 1e-4;
+    cqf::call_vanilla<double> call(S, K, T, r, q, sigma);
+    cqf::put_vanilla<double> put(S, K, T, r, q, sigma);
+    const cqf::greeks<double> c = call.evaluate(), p = put.evaluate();
+    EXPECT_NEAR(c.premium, call.premium(), 1e-12);
+    EXPECT_NEAR(c.delta, call.delta(), 1e-12);
+    EXPECT_NEAR(c.gamma, call.gamma(), 1e-12);
+    EXPECT_NEAR(c.vega, call.vega(), 1e-12);
+    EXPECT_NEAR(c.theta, call.theta(), 1e-12);
+    EXPECT_NEAR(c.rho, call.rho(), 1e-12);
+    EXPECT_NEAR(p.premium, put.premium(), 1e-12);
+    EXPECT_NEAR(p.delta, put.delta(), 1e-12);
+    EXPECT_NEAR(p.theta, put.theta(), 1e-12);
+    EXPECT_NEAR(p.rho, put.rho(), 1e-12);
+
+    // second order Greeks against central differences of first order ones
+    auto delta = [&](double s, double v, double t) { return cqf::call_vanilla<double>(s, K, t, r, q, v).delta(); };
+    auto vega = [&](double v) { return cqf::call_vanilla<double>(S, K, T, r, q, v).vega(); };
+    EXPECT_NEAR(c.vanna, (delta(S, sigma + h, T) - delta(S, sigma - h, T)) / (2 * h), 1e-6);
+    EXPECT_NEAR(c.volga, (vega(sigma + h) - vega(sigma - h)) / (2 * h), 1e-4);
+    EXPECT_NEAR(c.charm, -(delta(S, sigma, T + h) - delta(S, sigma, T - h)) / (2 * h), 1e-6);
+    EXPECT_NEAR(p.charm, c.charm - q * std::exp(-q * T), 1e-12);
+  }
+}
+TEST_F(TestSuite, vanilla) {
+  static_assert(sizeof(cqf::call_vanilla<double>) == 48);
+  static_assert(sizeof(cqf::put_vanilla<double>) == 48);
+  static_assert(std::is_trivially_copyable_v<cqf::call_vanilla<double>>);
+  static_assert(std::is_trivially_copyable_v<cqf::put_vanilla<double>>);
+
+  // put-call parity
+  constexpr cqf::call_vanilla<double> call(100., 105., 0.5, 0.03, 0.01, 0.2);
+  constexpr cqf::put_vanilla<double> put(100., 105., 0.5, 0.03, 0.01, 0.2);
+  EXPECT_NEAR(call.premium() - put.premium(), call.SPV() - call.KPV(), 1e-12);
+  EXPECT_NEAR(call.delta() - put.delta(), std::exp(-0.01 * 0.5), 1e-12);
+  EXPECT_NEAR(call.gamma(), put.gamma(), 1e-15);
+  EXPECT_NEAR(call.vega(), put.vega(), 1e-15);
+
+  std::vector<cqf::call_vanilla<double>> book(1000, call);
+  double total = 0.;
+  for (const auto &option : book) total += option.premium();
+  EXPECT_NEAR(total, 1000. * call.premium(), 1e-9);
+}
+
+TEST_F(TestSuite, norm_table) {
+  static_assert(cqf::norm_cdf_table(0.) == 0.5);
+  static_assert(cqf::norm_table<double>::size == CQF_NORM_TABLE_STEPS * CQF_NORM_TABLE_BOUND + 1);
+  constexpr double cdf = cqf::norm_cdf_table(1.2345);
+  EXPECT_NEAR(cdf, 0.5 * std::erfc(-1.2345 / std::sqrt(2.)), 2e-10);
+
+  double cdf_err = 0., pdf_err = 0.;
+  for (double x = -10.; x <= 10.; x += 1. / 1024.) {
+    cdf_err = std::max(cdf_err, std::abs(cqf::norm_cdf_table(x) - 0.5 * std::erfc(-x / std::sqrt(2.))));
+    pdf_err = std::max(pdf_err, std::abs(cqf::norm_pdf_table(x) - std::exp(-0.5 * x * x) / std::sqrt(2 * M_PI)));
+  }
+  std::cout << "norm_cdf_table max error " << cdf_err << ", norm_pdf_table max error " << pdf_err << std::endl;
+  EXPECT_LT(cdf_err, 2e-10);
+  EXPECT_LT(pdf_err, 3e-10);
+  EXPECT_TRUE(std::isnan(cqf::norm_cdf_table(std::nan(""))));
+  EXPECT_EQ(cqf::norm_cdf_table(-20.), 0.);
+  EXPECT_EQ(cqf::norm_cdf_table(20.), 1.);
+}
+
+TEST_F(TestSuite, portfolio) {
+  cqf::portfolio<double> book;
+  for (size_t i = 0; i < 3000; ++i) {
+    const double K = 60. + 80. * static_cast<double>(i) / 3000., T = 0.1 + static_cast<double>(i % 12) / 4.;
+    book.calls.push_back({cqf::call_vanilla<double>(100., K, T, 0.03, 0.01, 0.2 + static_cast<double>(i % 5) / 20.),
+                          static_cast<double>(i % 7) - 3.});
+    book.puts.push_back({cqf::put_vanilla<double>(100., K, T, 0.03, 0.01, 0.25), 1.});
+  }
+  for (size_t i = 0; i < 700; ++i) {
+    book.bonds.push_back({cqf::coupon_bond<double>(1. + static_cast<double>(i % 10), 4., 0.035), 10.});
+  }
+
+  cqf::portfolio_risk<double> serial{};
+  for (const auto &p : book.calls) {
+    serial.value += p.quantity * p.instrument.premium();
+    serial.delta += p.quantity * p.instrument.delta();
+    serial.vega += p.quantity * p.instrument.vega();
+  }
+  for (const auto &p : book.puts) {
+    serial.value += p.quantity * p.instrument.premium();
+    serial.delta += p.quantity * p.instrument.delta();
+    serial.vega += p.quantity * p.instrument.vega();
+  }
+  for (const auto &p : book.bonds) {
+    serial.value += p.quantity * p.instrument.price();
+    serial.dv01 += p.quantity * p.instrument.duration() * p.instrument.price() / 10000.;
+  }
+
+  cqf::thread_pool single(1), pool(4);
+  const auto start = std::chrono::high_resolution_clock::now();
+  const cqf::portfolio_risk<double> risk = cqf::revalue(book, pool);
+  const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+  std::cout << (book.calls.size() + book.puts.size() + book.bonds.size()) / elapsed.count()
+            << " positions/second on " << pool.size() << " workers" << std::endl;
+  const cqf::portfolio_risk<double> reference = cqf::revalue(book, single);
+
+  EXPECT_NEAR(risk.value, serial.value, 1e-9 * std::abs(serial.value));
+  EXPECT_NEAR(risk.delta, serial.delta, 1e-9 * std::abs(serial.delta));
+  EXPECT_NEAR(risk.vega, serial.vega, 1e-9 * std::abs(serial.vega));
+  EXPECT_NEAR(risk.dv01, serial.dv01, 1e-9 * std::abs(serial.dv01));
+  // deterministic reduction, independent of the number of workers
+  EXPECT_EQ(risk.value, reference.value);
+  EXPECT_EQ(risk.gamma, reference.gamma);
+  EXPECT_EQ(risk.dv01, reference.dv01);
+
+  std::vector<size_t> hits(10000, 0);
+  pool.parallel_for(hits.size(), [&](size_t i) { ++hits[i]; });
+  EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), 10000);
+
+  // a task submitting to its own pool runs the nested loop inline rather than waiting on itself
+  std::vector<size_t> nested(64 * 16, 0);
+  pool.parallel_for(64, [&](size_t i) {
+    pool.parallel_for(16, [&](size_t j) { ++nested[i * 16 + j]; });
+  });
+  EXPECT_EQ(std::count(nested.begin(), nested.end(), 1), 64 * 16);
+}
+TEST_F(TestSuite, philox) {
+  // known answers of Random123
+  constexpr auto zero = cqf::philox(0)({0, 0, 0, 0});
+  static_assert(zero[0] == 0x6627e8d5 && zero[1] == 0xe169c58d && zero[2] == 0xbc57ac4c && zero[3] == 0x9b00dbd8);
+  const auto ones = cqf::philox(~uint64_t{0})({~0u, ~0u, ~0u, ~0u});
+  EXPECT_EQ(ones[0], 0x408f276du);
+  EXPECT_EQ(ones[3], 0x6d5451fdu);
+
+  std::vector<double> z(100000);
+  cqf::normal_fill(cqf::philox(42), 7, z.data(), z.size());
+  double mean = 0., var = 0.;
+  for (double v : z) {
+    mean += v / z.size();
+    var += v * v / z.size();
+  }
+  EXPECT_NEAR(mean, 0., 0.02);
+  EXPECT_NEAR(var, 1., 0.02);
+  std::vector<double> head(11);
+  cqf::normal_fill(cqf::philox(42), 7, head.data(), head.size());
+  EXPECT_TRUE(std::equal(head.begin(), head.end(), z.begin()));
+}
+
+TEST_F(TestSuite, monte_carlo) {
+  const double S = 100., K = 100., T = 1., r = 0.03, q = 0.01, sigma = 0.2;
+  cqf::thread_pool pool(4), single(1);
+  cqf::mc_settings settings;
+  settings.paths = 20000;
+  settings.steps = 16;
+
+  const auto start = std::chrono::high_resolution_clock::now();
+  const auto plain = cqf::monte_carlo(cqf::european<double, cqf::option_side::call>{K}, S, T, r, q, sigma,
+                                      settings, pool);
+  const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+  std::cout << plain.paths / elapsed.count() << " paths/second" << std::endl;
+  const double call = cqf::call_vanilla<double>(S, K, T, r, q, sigma).premium();
+  EXPECT_NEAR(plain.price, call, 4 * plain.error);
+
+  // reproducible on any number of threads
+  const auto serial = cqf::monte_carlo(cqf::european<double, cqf::option_side::call>{K}, S, T, r, q, sigma,
+                                       settings, single);
+  EXPECT_EQ(plain.price, serial.price);
+
+  // the call is its own perfect control
+  settings.control_strike = K;
+  const auto controlled = cqf::monte_carlo(cqf::european<double, cqf::option_side::call>{K}, S, T, r, q, sigma,
+                                           settings, pool);
+  EXPECT_NEAR(controlled.price, call, 1e-9);
+
+  const auto asian = cqf::monte_carlo(cqf::asian<double, cqf::option_side::call>{K}, S, T, r, q, sigma,
+                                      settings, pool);
+  EXPECT_LT(asian.error, plain.error);
+  EXPECT_GT(asian.price, 0.);
+  EXPECT_LT(asian.price, call);
+
+  // in-out parity holds path by path
+  settings.control_strike = 0;
+  const auto out = cqf::monte_carlo(cqf::barrier<double, cqf::option_side::call>{K, 90., cqf::barrier_type::down_and_out},
+                                    S, T, r, q, sigma, settings, pool);
+  const auto in = cqf::monte_carlo(cqf::barrier<double, cqf::option_side::call>{K, 90., cqf::barrier_type::down_and_in},
+                                   S, T, r, q, sigma, settings, pool);
+  const auto european = cqf::monte_carlo(cqf::european<double, cqf::option_side::call>{K}, S, T, r, q, sigma,
+                                         settings, pool);
+  EXPECT_NEAR(out.price + in.price, european.price, 1e-9);
+
+  const auto lookback = cqf::monte_carlo(cqf::lookback<double, cqf::option_side::put>{}, S, T, r, q, sigma,
+                                         settings, pool);
+  EXPECT_GT(lookback.price, cqf::put_vanilla<double>(S, K, T, r, q, sigma).premium());
+
+  settings.paths = 0;
+  const auto empty = cqf::monte_carlo(cqf::european<double, cqf::option_side::call>{K}, S, T, r, q, sigma,
+                                      settings, pool);
+  EXPECT_TRUE(std::isnan(empty.price));
+  EXPECT_EQ(empty.paths, 0u);
+}
+TEST_F(TestSuite, norm_ppf) {
+  static_assert(cqf::norm_ppf(0.5) == 0.);
+  constexpr double q = cqf::norm_ppf(0.975), refined = cqf::norm_ppf_refined(0.975);
+  EXPECT_NEAR(q, 1.959963984540054, 1e-15);
+  EXPECT_NEAR(refined, 1.959963984540054, 1e-14);  // limited by the constexpr norm_cdf
+  // the upper half is as accurate in terms of 1 - p, which a double precision p close to 1 cannot carry
+  for (double x = -37.; x <= 0.; x += 1. / 16.) {
+    const double p = cqf::norm_cdf(x);
+    EXPECT_NEAR(cqf::norm_ppf(p), x, 1e-14 * std::max(std::abs(x), 1.));
+  }
+  EXPECT_NEAR(cqf::norm_ppf(0.99), -cqf::norm_ppf(0.01), 1e-14);
+  EXPECT_EQ(cqf::norm_ppf(0.), -std::numeric_limits<double>::infinity());
+  EXPECT_TRUE(std::isnan(cqf::norm_ppf(1.5)));
+
+  // one Halley step carries the double precision approximation to long double precision
+  const long double p = 0.3L, x = cqf::norm_ppf_refined(p);
+  EXPECT_LT(std::abs(0.5L * std::erfc(-x / std::sqrt(2.L)) - p), 1e-18L);
+}
+
+TEST_F(TestSuite, sobol) {
+  static_assert(cqf::sobol_table::directions[0][0] == 1u << 31);
+  constexpr double first[] = {0., 0.5, 0.75, 0.25, 0.375, 0.875, 0.625, 0.125};
+  constexpr double second[] = {0., 0.5, 0.25, 0.75, 0.375, 0.875, 0.125, 0.625};
+  cqf::sobol<cqf::sobol_dimensions> sequence;
+  double u[cqf::sobol_dimensions];
+  for (size_t n = 0; n < 8; ++n) {
+    sequence.next(u);
+    EXPECT_EQ(u[0], first[n]);
+    EXPECT_EQ(u[1], second[n]);
+  }
+
+  // skip-ahead lands on the same points as stepping
+  cqf::sobol<cqf::sobol_dimensions> stepped, skipped(1000);
+  double v[cqf::sobol_dimensions];
+  for (size_t n = 0; n < 1000; ++n) stepped.next(u);
+  for (size_t n = 0; n < 10; ++n) {
+    stepped.next(u);
+    skipped.next(v);
+    EXPECT_TRUE(std::equal(u, u + cqf::sobol_dimensions, v));
+  }
+
+  // the first 2^k points of every dimension stratify [0, 1) into 2^k intervals
+  cqf::sobol<cqf::sobol_dimensions> net;
+  std::vector<std::vector<int>> bins(cqf::sobol_dimensions, std::vector<int>(256, 0));
+  for (size_t n = 0; n < 256; ++n) {
+    net.next(u);
+    for (size_t d = 0; d < cqf::sobol_dimensions; ++d) ++bins[d][static_cast<size_t>(u[d] * 256)];
+  }
+  for (const auto &bin : bins) EXPECT_EQ(std::count(bin.begin(), bin.end(), 1), 256);
+}
+
+TEST_F(TestSuite, brownian_bridge) {
+  const cqf::brownian_bridge bridge(10);
+  std::vector<double> z(10, 0.), dw(10);
+  z[0] = 1.;
+  bridge.transform(z.data(), dw.data());
+  // the first draw alone spreads the terminal value evenly
+  for (double d : dw) EXPECT_NEAR(d, 1. / std::sqrt(10.), 1e-14);
+
+  // increments of the bridge are independent standard normals
+  std::vector<double> draws(10), sum(10, 0.), square(10, 0.);
+  for (size_t i = 0; i < 20000; ++i) {
+    cqf::normal_fill(cqf::philox(3), i, draws.data(), draws.size());
+    bridge.transform(draws.data(), dw.data());
+    for (size_t k = 0; k < 10; ++k) {
+      sum[k] += dw[k] / 20000.;
+      square[k] += dw[k] * dw[k] / 20000.;
+    }
+  }
+  for (size_t k = 0; k < 10; ++k) {
+    EXPECT_NEAR(sum[k], 0., 0.05);
+    EXPECT_NEAR(square[k], 1., 0.05);
+  }
+}
+
+TEST_F(TestSuite, quasi_monte_carlo) {
+  const double S = 100., K = 100., T = 1., r = 0.03, q = 0.01, sigma = 0.2;
+  const double call = cqf::call_vanilla<double>(S, K, T, r, q, sigma).premium();
+  cqf::thread_pool pool(4);
+  cqf::mc_settings settings;
+  settings.paths = 4095;
+  settings.steps = 32;
+  settings.quasi = true;
+
+  const auto quasi = cqf::monte_carlo(cqf::european<double, cqf::option_side::call>{K}, S, T, r, q, sigma,
+                                      settings, pool);
+  settings.quasi = false;
+  const auto pseudo = cqf::monte_carlo(cqf::european<double, cqf::option_side::call>{K}, S, T, r, q, sigma,
+                                       settings, pool);
+  std::cout << "sobol error " << quasi.price - call << ", philox error " << pseudo.price - call
+            << " +- " << pseudo.error << std::endl;
+  EXPECT_NEAR(quasi.price, call, 0.2 * pseudo.error);
+}
+TEST_F(TestSuite, adaptive_integral) {
+  size_t calls = 0;
+  const std::function<double(double)> density = [&calls](double x) {
+    ++calls;
+    return std::exp(-x * x / 2);
+  };
+  const double expected = std::sqrt(2 * M_PI);
+
+  const auto kronrod = cqf::integrate_kronrod(density, -100., 100.);
+  EXPECT_EQ(kronrod.evaluations, calls);
+  EXPECT_NEAR(kronrod.value, expected, 1e-12 * expected);
+  EXPECT_LE(std::abs(kronrod.value - expected), kronrod.error + 1e-15);
+
+  calls = 0;
+  const auto simpson = cqf::integrate_simpson(density, -100., 100.);
+  EXPECT_EQ(simpson.evaluations, calls);
+  EXPECT_NEAR(simpson.value, expected, 1e-10 * expected);
+
+  calls = 0;
+  const double uniform = cqf::integrate_uniform(density, -100., 100.);
+  std::cout << "gauss-kronrod " << kronrod.evaluations << " calls, simpson " << simpson.evaluations
+            << " calls, uniform " << calls << " calls" << std::endl;
+  EXPECT_NEAR(uniform, expected, 1e-10 * expected);
+  EXPECT_LT(kronrod.evaluations, calls / 4);
+  EXPECT_LT(simpson.evaluations, calls);
+
+  // a kink is only resolved where it is
+  const std::function<double(double)> kink = [](double x) { return std::abs(x - 0.3); };
+  EXPECT_NEAR(cqf::integrate(kink, 0., 1.), 0.29, 1e-12);
+
+  // the rule is generated in the precision of the integral, and matches the tabulated one
+  static_assert(cqf::impl::kronrod_legendre<double>.nodes[0] == 0.991455371120812639206854697526329);
+  EXPECT_NEAR(cqf::impl::kronrod_legendre<long double>.kronrod[5], 0.190350578064785409913256402421014l, 1e-19l);
+  const long double e = cqf::integrate<long double>([](long double x) { return std::exp(x); }, 0.l, 1.l);
+  EXPECT_NEAR(e, std::exp(1.l) - 1, 4 * cqf::limits<long double>::epsilon());
+}
+TEST_F(TestSuite, integral_callable) {
+  // a constexpr lambda integrates at compile time
+  constexpr double square = cqf::integrate([](double x) { return x * x; }, 0., 1.);
+  static_assert(square > 0.333333333333 && square < 0.333333333334);
+
+  // a batch integrand receives every abscissa of a rule in one call
+  struct batch_density {
+    size_t *calls;
+    size_t *points;
+    void operator()(const double *x, double *y, size_t n) const {
+      ++*calls;
+      *points += n;
+      for (size_t i = 0; i < n; ++i) {
+        y[i] = -x[i] * x[i] / 2;
+      }
+      cqf::simd::exp(y, y, n);
+    }
+  };
+  size_t calls = 0, points = 0;
+  const auto batch = cqf::integrate_kronrod(batch_density{&calls, &points}, -10., 10.);
+  const auto plain = cqf::integrate_kronrod([](double x) { return std::exp(-x * x / 2); }, -10., 10.);
+  EXPECT_NEAR(batch.value, std::sqrt(2 * M_PI), 1e-12);
+  EXPECT_NEAR(batch.value, plain.value, 1e-13);
+  EXPECT_EQ(batch.evaluations, plain.evaluations);
+  EXPECT_EQ(points, batch.evaluations);
+  EXPECT_EQ(calls, (batch.evaluations / 15 + 1) / 2);
+
+  calls = points = 0;
+  const auto simpson = cqf::integrate_simpson(batch_density{&calls, &points}, -10., 10.);
+  EXPECT_NEAR(simpson.value, std::sqrt(2 * M_PI), 1e-9);
+  EXPECT_EQ(points, simpson.evaluations);
+}
+TEST_F(TestSuite, iterative_sum) {
+  // ten million terms of 0.1, whose naive sum is off by about 1e-4
+  cqf::compensated_sum<double> tenth;
+  for (size_t i = 0; i < 10000000; ++i) {
+    tenth += 0.1;
+  }
+  EXPECT_EQ(tenth.value(), 1e6);
+
+  // a partition far deeper than any recursion would allow, with a batch integrand
+  const auto cube = [](const double *x, double *y, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      y[i] = x[i] * x[i] * x[i];
+    }
+  };
+  EXPECT_NEAR(cqf::impl::integrate_part(cube, 0., 2., 1u << 22), 4., 1e-12);
+
+  constexpr double square = cqf::impl::integrate_part([](double x) { return x * x; }, 0., 3., 1u << 14);
+  static_assert(square > 9. - 1e-9 && square < 9. + 1e-9);
+
+  // monthly coupons over a century
+  const cqf::coupon_bond<double> century(100., 4., 0.04, 12);
+  double expected = (100. + 4. / 12) * std::exp(-0.04 * 100.);
+  for (size_t k = 1; k < 1200; ++k) {
+    expected += 4. / 12 * std::exp(-0.04 * (100. - static_cast<double>(k) / 12));
+  }
+  EXPECT_NEAR(century.price(), expected, 1e-9 * expected);
+  EXPECT_GT(century.duration(), 0.);
+}
+TEST_F(TestSuite, gauss) {
+  // rules are generated at compile time
+  static_assert(cqf::gauss_legendre<double, 3>::nodes[1] == 0.);
+  static_assert(cqf::gauss_legendre<double, 3>::weights[1] > 8. / 9 - 1e-15
+                    && cqf::gauss_legendre<double, 3>::weights[1] < 8. / 9 + 1e-15);
+
+  // the weights sum to the integral of the weight function
+  const auto total = [](const auto &weights) {
+    double s = 0.;
+    for (const double w : weights) { s += w; }
+    return s;
+  };
+  EXPECT_NEAR(total(cqf::gauss_legendre<double, 20>::weights), 2., 1e-14);
+  EXPECT_NEAR(total(cqf::gauss_laguerre<double, 20>::weights), 1., 1e-13);
+  EXPECT_NEAR(total(cqf::gauss_hermite<double, 60>::weights), std::sqrt(M_PI), 1e-13);
+  using hermite = cqf::gauss_hermite<double, 60>;
+  for (size_t i = 1; i < hermite::size; ++i) {
+    EXPECT_LT(hermite::nodes[i - 1], hermite::nodes[i]);
+  }
+
+  // exact for polynomials of degree 2N - 1
+  EXPECT_NEAR(cqf::integrate_gauss<5>([](double x) { return cqf::power(x, 9) + x * x; }, 0., 2.),
+              1024. / 10 + 8. / 3, 1e-12);
+  // x^4 e^-x over the half line is 4!
+  using laguerre = cqf::gauss_laguerre<double, 8>;
+  EXPECT_NEAR(cqf::integrate_gauss<laguerre>([](double x) { return cqf::power(x, 4); }), 24., 1e-11);
+  // E[e^X] of a normal is e^(mu + sigma^2 / 2)
+  EXPECT_NEAR(cqf::integrate_gauss_normal<40>([](double x) { return std::exp(x); }, 0.1, 0.3),
+              std::exp(0.1 + 0.045), 1e-14);
+  EXPECT_NEAR(cqf::integrate_gauss_normal([](double x) { return std::cos(x); }, 0., 1.),
+              std::exp(-0.5), 1e-14);
+}
+TEST_F(TestSuite, cos_method) {
+  // a chain of 200 strikes against the closed form
+  const size_t n = 200;
+  std::vector<double> K(n), call(n), put(n);
+  for (size_t i = 0; i < n; ++i) {
+    K[i] = 50. + static_cast<double>(i);
+  }
+  const cqf::gbm<double> gbm{0.25};
+  cqf::cos_price(gbm, true, 100., K.data(), n, 1., 0.05, 0.02, call.data());
+  cqf::cos_price(gbm, false, 100., K.data(), n, 1., 0.05, 0.02, put.data());
+  for (size_t i = 0; i < n; ++i) {
+    EXPECT_NEAR(call[i], cqf::call_vanilla<double>(100., K[i], 1., 0.05, 0.02, 0.25).premium(), 1e-10);
+    EXPECT_NEAR(put[i], cqf::put_vanilla<double>(100., K[i], 1., 0.05, 0.02, 0.25).premium(), 1e-10);
+  }
+
+  // reference values of Fang and Oosterlee
+  const double at_the_money = 100.;
+  double price = 0.;
+  cqf::cos_price(cqf::heston<double>{1.5768, 0.0398, 0.5751, -0.5711, 0.0175}, true,
+                 100., &at_the_money, 1, 1., 0., 0., &price);
+  EXPECT_NEAR(price, 5.785155450, 1e-7);
+
+  const double in_the_money = 90.;
+  const cqf::variance_gamma<double> vg{0.12, 0.2, -0.14};
+  cqf::cos_price(vg, true, 100., &in_the_money, 1, 1., 0.1, 0., &price);
+  EXPECT_NEAR(price, 19.099354724, 1e-8);
+  cqf::cos_price(vg, true, 100., &in_the_money, 1, 0.1, 0.1, 0., &price, 4096);
+  EXPECT_NEAR(price, 10.993703187, 1e-7);
+}
+TEST_F(TestSuite, finite_difference) {
+  // tridiagonal solve against the matrix product
+  const double lower[5] = {0., -1., -1., -1., -1.}, diag[5] = {4., 4., 4., 4., 4.}, upper[5] = {-1., -1., -1., -1., 0.};
+  const double rhs[5] = {1., 2., 3., 4., 5.};
+  double x[5], ratio[5], pivot[5];
+  cqf::impl::thomas(lower, diag, upper, rhs, x, ratio, pivot, 5);
+  for (size_t i = 0; i < 5; ++i) {
+    const double product = diag[i] * x[i] + (i > 0 ? lower[i] * x[i - 1] : 0.) + (i < 4 ? upper[i] * x[i + 1] : 0.);
+    EXPECT_NEAR(product, rhs[i], 1e-15);
+  }
+
+  // European limit against the closed form
+  cqf::fd_settings european;
+  european.american = false;
+  const auto put = cqf::finite_difference(false, 36., 40., 1., 0.06, 0., 0.2, european);
+  const cqf::put_vanilla<double> bs(36., 40., 1., 0.06, 0., 0.2);
+  EXPECT_NEAR(put.premium, bs.premium(), 1e-4);
+  EXPECT_NEAR(put.delta, bs.delta(), 5e-5);
+  EXPECT_NEAR(put.gamma, bs.gamma(), 1e-4);
+  EXPECT_NEAR(put.theta, bs.theta(), 1e-3);
+  const auto call = cqf::finite_difference(true, 100., 100., 0.5, 0.05, 0.02, 0.3, european);
+  EXPECT_NEAR(call.premium, cqf::call_vanilla<double>(100., 100., 0.5, 0.05, 0.02, 0.3).premium(), 1e-4);
+
+  // American put of Longstaff and Schwartz, 4.48667 on a fine lattice
+  const auto american = cqf::finite_difference(false, 36., 40., 1., 0.06, 0., 0.2);
+  EXPECT_NEAR(american.premium, 4.48667, 1e-4);
+  EXPECT_GT(american.premium, bs.premium());
+  // deep in the exercise region the option is its payoff
+  const auto exercised = cqf::finite_difference(false, 20., 40., 1., 0.06, 0., 0.2);
+  EXPECT_NEAR(exercised.premium, 20., 1e-10);
+  EXPECT_NEAR(exercised.delta, -1., 1e-10);
+  // without dividends an American call is European
+  EXPECT_NEAR(cqf::finite_difference(true, 100., 100., 0.5, 0.05, 0., 0.3).premium,
+              cqf::call_vanilla<double>(100., 100., 0.5, 0.05, 0., 0.3).premium(), 1e-4);
+
+  // a chain across the pool prices as one option at a time
+  const size_t n = 16;
+  std::vector<double> S(n), K(n, 40.), T(n, 1.), r(n, 0.06), q(n, 0.), sigma(n, 0.2);
+  std::vector<double> premium(n), delta(n), gamma(n), theta(n);
+  std::unique_ptr<bool[]> calls(new bool[n]);
+  for (size_t i = 0; i < n; ++i) {
+    S[i] = 30. + static_cast<double>(i);
+    calls[i] = i % 2 == 0;
+  }
+  const cqf::vanilla_chain<double> chain{S.data(), K.data(), T.data(), r.data(), q.data(), sigma.data(), calls.get(), n};
+  const cqf::vanilla_chain_greeks<double> out{premium.data(), delta.data(), gamma.data(), nullptr, theta.data(), nullptr};
+  cqf::thread_pool pool(2);
+  cqf::finite_difference_chain(chain, out, pool);
+  for (size_t i = 0; i < n; ++i) {
+    const auto single = cqf::finite_difference(calls[i], S[i], 40., 1., 0.06, 0., 0.2);
+    EXPECT_EQ(premium[i], single.premium);
+    EXPECT_EQ(theta[i], single.theta);
+  }
+}
+TEST_F(TestSuite, lattice) {
+  const cqf::call_vanilla<double> call(100., 110., 1., 0.05, 0.02, 0.25);
+  const cqf::put_vanilla<double> put(100., 110., 1., 0.05, 0.02, 0.25);
+  const auto price = [](bool is_call, cqf::lattice_tree tree, size_t steps, bool richardson) {
+    cqf::lattice_settings settings;
+    settings.tree = tree;
+    settings.steps = steps;
+    settings.american = false;
+    settings.richardson = richardson;
+    return cqf::lattice(is_call, 100., 110., 1., 0.05, 0.02, 0.25, settings);
+  };
+
+  // European limit, Leisen-Reimer on 200 steps beating Cox-Ross-Rubinstein on 2000
+  const double lr = price(true, cqf::lattice_tree::leisen_reimer, 200, false).premium;
+  const double crr = price(true, cqf::lattice_tree::crr, 2000, false).premium;
+  EXPECT_NEAR(lr, call.premium(), 1e-4);
+  EXPECT_NEAR(crr, call.premium(), 5e-3);
+  EXPECT_LT(std::abs(lr - call.premium()), std::abs(crr - call.premium()));
+  EXPECT_NEAR(price(true, cqf::lattice_tree::leisen_reimer, 200, true).premium, call.premium(), 1e-6);
+  EXPECT_NEAR(price(true, cqf::lattice_tree::trinomial, 2000, false).premium, call.premium(), 5e-3);
+  const auto european = price(false, cqf::lattice_tree::leisen_reimer, 200, true);
+  EXPECT_NEAR(european.premium, put.premium(), 1e-6);
+  EXPECT_NEAR(european.delta, put.delta(), 5e-4);
+  EXPECT_NEAR(european.gamma, put.gamma(), 1e-4);
+  EXPECT_NEAR(price(false, cqf::lattice_tree::trinomial, 2000, false).delta, put.delta(), 5e-4);
+
+  // American put of Longstaff and Schwartz, 4.48667 on a fine lattice
+  const double american = cqf::lattice(false, 36., 40., 1., 0.06, 0., 0.2).premium;
+  EXPECT_NEAR(american, 4.48667, 2e-4);
+  cqf::lattice_settings crr_settings;
+  crr_settings.tree = cqf::lattice_tree::crr;
+  crr_settings.steps = 1000;
+  EXPECT_NEAR(cqf::lattice(false, 36., 40., 1., 0.06, 0., 0.2, crr_settings).premium, 4.48667, 2e-4);
+  // without dividends an American call is European, up to the first order extrapolation
+  EXPECT_NEAR(cqf::lattice(true, 100., 110., 1., 0.05, 0., 0.25).premium,
+              cqf::call_vanilla<double>(100., 110., 1., 0.05, 0., 0.25).premium(), 5e-5);
+
+  // quarterly exercise lies between the European and the American put
+  cqf::lattice_settings bermudan;
+  bermudan.american = false;
+  bermudan.bermudan = 4;
+  const double quarterly = cqf::lattice(false, 36., 40., 1., 0.06, 0., 0.2, bermudan).premium;
+  EXPECT_GT(quarterly, cqf::put_vanilla<double>(36., 40., 1., 0.06, 0., 0.2).premium());
+  EXPECT_LT(quarterly, american);
+}
+TEST_F(TestSuite, bond_analytics) {
+  // one fused pass agrees with the separate walks of the schedule, at compile time too
+  constexpr cqf::coupon_bond<double> bond(10., 4., 0.035);
+  constexpr cqf::bond_analytics<double> fused = bond.analytics();
+  static_assert(fused.price > 100. && fused.duration > 0.);
+  EXPECT_NEAR(fused.price, bond.price(), 1e-13 * bond.price());
+  EXPECT_NEAR(fused.duration, bond.duration(), 1e-13 * bond.duration());
+  EXPECT_NEAR(fused.convexity, bond.convexity(), 1e-13 * bond.convexity());
+  EXPECT_NEAR(fused.dv01, bond.duration() * bond.price() / 10000., 1e-15);
+  // DV01 against a bump of one basis point of the yield
+  const double bumped = cqf::coupon_bond<double>(10., 4., 0.0349).price() - cqf::coupon_bond<double>(10., 4., 0.0351).price();
+  EXPECT_NEAR(fused.dv01, bumped / 2., 1e-7);
+
+  // the schedule lists 20 semiannual payments, the principal with the last one
+  double times[20], amounts[20];
+  ASSERT_EQ(bond.cash_flow_count(), 20u);
+  EXPECT_EQ(bond.cash_flows(times, amounts), 20u);
+  EXPECT_DOUBLE_EQ(times[0], 0.5);
+  EXPECT_EQ(times[19], 10.);
+  EXPECT_EQ(amounts[0], 2.);
+  EXPECT_EQ(amounts[19], 102.);
+
+  // a batch of bonds matches bond by bond, at their own and at shifted yields
+  std::vector<cqf::coupon_bond<double>> bonds;
+  for (size_t i = 0; i < 3000; ++i) {
+    const int8_t m = static_cast<int8_t>(i % 3 == 0 ? 1 : i % 3 == 1 ? 2 : 12);
+    bonds.emplace_back(0.25 + static_cast<double>(i % 120) / 4., 2. + static_cast<double>(i % 5), 0.01 + static_cast<double>(i % 9) / 200., m);
+  }
+  const cqf::bond_schedule<double> schedule(bonds);
+  EXPECT_EQ(schedule.size(), bonds.size());
+  std::vector<double> price(bonds.size()), dv01(bonds.size()), duration(bonds.size()), convexity(bonds.size());
+  const cqf::bond_chain_analytics<double> out{price.data(), dv01.data(), duration.data(), convexity.data()};
+  schedule.evaluate(out);
+  for (size_t i = 0; i < bonds.size(); ++i) {
+    const cqf::bond_analytics<double> a = bonds[i].analytics();
+    EXPECT_NEAR(price[i], a.price, 1e-13 * a.price);
+    EXPECT_NEAR(dv01[i], a.dv01, 1e-13 * a.dv01);
+    EXPECT_NEAR(duration[i], a.duration, 1e-13 * a.duration);
+    EXPECT_NEAR(convexity[i], a.convexity, 1e-13 * a.convexity);
+  }
+  std::vector<double> shifted(bonds.size());
+  for (size_t i = 0; i < bonds.size(); ++i) {
+    shifted[i] = bonds[i].yield_to_maturity() + 0.01;
+  }
+  schedule.evaluate(shifted.data(), out);
+  for (size_t i = 0; i < bonds.size(); i += 97) {
+    const int8_t m = static_cast<int8_t>(i % 3 == 0 ? 1 : i % 3 == 1 ? 2 : 12);
+    const cqf::coupon_bond<double> moved(0.25 + static_cast<double>(i % 120) / 4., 2. + static_cast<double>(i % 5), shifted[i], m);
+    EXPECT_NEAR(price[i], moved.price(), 1e-13 * price[i]);
+  }
+}
+TEST_F(TestSuite, yield_curve) {
+  // a flat curve discounts as the yield to maturity
+  const cqf::yield_curve<double> flat(0.035);
+  const cqf::coupon_bond<double> bond(10., 4., 0.035);
+  EXPECT_NEAR(flat.discount(7.3), std::exp(-0.035 * 7.3), 1e-15);
+  EXPECT_NEAR(flat.zero_rate(42.), 0.035, 1e-15);
+  EXPECT_NEAR(bond.price(flat), bond.price(), 1e-12);
+  EXPECT_NEAR(bond.analytics(flat).duration, bond.duration(), 1e-12);
+
+  // market quotes off a smooth zero curve: deposits, then semiannual par swaps every quarter up to 50 years
+  const auto zero = [](double t) { return 0.01 + 0.03 * (1. - std::exp(-t / 5.)) + 0.002 * t * std::exp(-t / 10.); };
+  const auto P = [&](double t) { return std::exp(-zero(t) * t); };
+  std::vector<cqf::curve_instrument<double>> quotes;
+  for (const double T : {1. / 52, 1. / 12, 0.25, 0.5}) {
+    quotes.push_back(cqf::curve_instrument<double>::deposit(T, (1. / P(T) - 1.) / T));
+  }
+  for (size_t k = 3; k <= 200; ++k) {
+    const double T = static_cast<double>(k) / 4.;
+    double annuity = 0.;
+    for (double t = T; t > 1e-12; t -= 0.5) {
+      annuity += 0.5 * P(t);
+    }
+    quotes.push_back(cqf::curve_instrument<double>::swap(T, (1. - P(T)) / annuity));
+  }
+  // in any order, every payment falling on a knot, which recovers the zero curve exactly
+  std::reverse(quotes.begin(), quotes.end());
+  cqf::yield_curve<double> curve(quotes.data(), quotes.size());
+  EXPECT_EQ(curve.size(), quotes.size() + 1);
+  for (const auto &quote : quotes) {
+    EXPECT_NEAR(curve.zero_rate(quote.T), zero(quote.T), 1e-12);
+  }
+  EXPECT_NEAR(curve.discount(0.25), P(0.25), 1e-14);
+  // between knots, the lookup table lands on the segment of the knot before
+  EXPECT_NEAR(curve.discount(10.1), curve.discount(10.) * std::exp(-curve.forward_rate(10.1) * 0.1), 1e-15);
+
+  // a bond paying between knots, rebuilt in place with a knot of its own
+  const double fair = cqf::coupon_bond<double>(30.1, 5., 0., 2).price(curve) + 0.5;
+  quotes.push_back(cqf::curve_instrument<double>::bond(30.1, 5., fair, 2));
+  curve.bootstrap(quotes.data(), quotes.size());
+  EXPECT_NEAR(cqf::coupon_bond<double>(30.1, 5., 0., 2).price(curve), fair, 1e-11);
+  EXPECT_NEAR(curve.zero_rate(30.), zero(30.), 1e-12);
+  EXPECT_NEAR(curve.zero_rate(0.5), zero(0.5), 1e-12);
+
+  // swaps whose first payment falls on the last knot fitted
+  std::vector<cqf::curve_instrument<double>> short_end;
+  for (const double T : {0.25, 0.5}) {
+    short_end.push_back(cqf::curve_instrument<double>::deposit(T, (1. / P(T) - 1.) / T));
+  }
+  for (const double T : {1., 2.}) {
+    double annuity = 0.;
+    for (double t = T; t > 1e-12; t -= 0.5) {
+      annuity += 0.5 * P(t);
+    }
+    short_end.push_back(cqf::curve_instrument<double>::swap(T, (1. - P(T)) / annuity));
+  }
+  const cqf::yield_curve<double> short_curve(short_end.data(), short_end.size());
+  EXPECT_EQ(short_curve.size(), 5u);
+  EXPECT_NEAR(short_curve.zero_rate(1.), zero(1.), 1e-12);
+  double swap = short_curve.discount(2.);
+  for (const double t : {0.5, 1., 1.5, 2.}) {
+    swap += 0.5 * short_end.back().rate * short_curve.discount(t);
+  }
+  EXPECT_NEAR(swap, 1., 1e-13);
+
+  // options discount on the zero rate to maturity
+  const cqf::call_vanilla<double> on_curve(100., 100., 2., curve, 0.01, 0.2);
+  const cqf::call_vanilla<double> flat_rate(100., 100., 2., zero(2.), 0.01, 0.2);
+  EXPECT_NEAR(on_curve.premium(), flat_rate.premium(), 1e-10);
+  const cqf::put_vanilla<double> dividends(100., 100., 2., curve, cqf::yield_curve<double>(0.01), 0.2);
+  EXPECT_NEAR(dividends.premium(), cqf::put_vanilla<double>(100., 100., 2., zero(2.), 0.01, 0.2).premium(), 1e-10);
+}
+TEST_F(TestSuite, revaluation) {
+  const std::vector<double> knots{0.5, 1., 2., 5., 10., 30.};
+  std::vector<double> zeros{0.02, 0.022, 0.025, 0.03, 0.033, 0.035};
+  std::vector<double> spots{100., 50., 200.}, vols{0.2, 0.3, 0.25, 0.4};
+  // 300 options, each on one of the spots and volatilities, and 50 bonds, the last ones beyond the last knot
+  const auto strike = [](size_t i) { return (i % 3 == 0 ? 100. : 50.) * (0.7 + 0.002 * static_cast<double>(i)); };
+  const auto maturity = [](size_t i) { return 0.1 + 0.05 * static_cast<double>(i); };
+  const auto quantity = [](size_t i) { return i % 5 == 0 ? -2. : 1.; };
+  const auto bond = [](size_t i) { return cqf::coupon_bond<double>(0.7 + 0.75 * static_cast<double>(i), 4., 0.035); };
+  const auto build = [&]() {
+    cqf::revaluation<double> book(knots.data(), zeros.data(), knots.size());
+    for (const double S : spots) {
+      book.add_spot(S);
+    }
+    for (const double sigma : vols) {
+      book.add_vol(sigma);
+    }
+    for (size_t i = 0; i < 300; ++i) {
+      book.add_option(i % 2 == 0, i % 3, i % 4, strike(i), maturity(i), 0.01, quantity(i));
+    }
+    for (size_t i = 0; i < 50; ++i) {
+      book.add_bond(bond(i), 10.);
+    }
+    return book;
+  };
+
+  // initially, the value of every instrument priced from scratch on the same curve
+  cqf::revaluation<double> book = build();
+  std::vector<double> P;
+  for (size_t k = 0; k < knots.size(); ++k) {
+    P.push_back(std::exp(-zeros[k] * knots[k]));
+  }
+  const cqf::yield_curve<double> curve(knots.data(), P.data(), P.size());
+  double value = 0., delta = 0.;
+  for (size_t i = 0; i < 300; ++i) {
+    const double S = spots[i % 3], sigma = vols[i % 4];
+    if (i % 2 == 0) {
+      const cqf::call_vanilla<double> option(S, strike(i), maturity(i), curve, 0.01, sigma);
+      value += quantity(i) * option.premium();
+      delta += quantity(i) * option.delta();
+    } else {
+      const cqf::put_vanilla<double> option(S, strike(i), maturity(i), curve, 0.01, sigma);
+      value += quantity(i) * option.premium();
+      delta += quantity(i) * option.delta();
+    }
+  }
+  for (size_t i = 0; i < 50; ++i) {
+    value += 10. * bond(i).price(curve);
+  }
+  EXPECT_EQ(book.pending(), 0);
+  EXPECT_NEAR(book.risk().value, value, 1e-9 * value);
+  EXPECT_NEAR(book.risk().delta, delta, 1e-9 * std::abs(delta));
+
+  // a tick marks its dependents once, the estimate follows it and risk agrees with a book built from scratch
+  book.set_spot(1, 50.5);
+  book.set_spot(1, 51.);
+  spots[1] = 51.;
+  EXPECT_EQ(book.pending(), 100);
+  const double estimate = book.estimate();
+  cqf::portfolio_risk<double> risk = book.risk();
+  EXPECT_NEAR(estimate, risk.value, 1e-5 * risk.value);
+  EXPECT_EQ(book.pending(), 0);
+  EXPECT_NEAR(risk.value, build().risk().value, 1e-12 * risk.value);
+  EXPECT_NEAR(risk.gamma, build().risk().gamma, 1e-12 * std::abs(risk.gamma));
+
+  book.set_vol(2, 0.255);
+  vols[2] = 0.255;
+  EXPECT_EQ(book.pending(), 75);
+  const double vol_estimate = book.estimate();
+  EXPECT_NE(vol_estimate, risk.value);
+  risk = book.risk();
+  EXPECT_NEAR(vol_estimate, risk.value, 1e-5 * value);
+  EXPECT_NEAR(risk.vega, build().risk().vega, 1e-12 * std::abs(risk.vega));
+
+  // a knot moves the options maturing around it and the bonds paying around or beyond it
+  book.set_rate(3, 0.0305);
+  zeros[2] = 0.0305;
+  EXPECT_GT(book.pending(), 0);
+  EXPECT_LT(book.pending(), 350);
+  const double rate_estimate = book.estimate();
+  EXPECT_NE(rate_estimate, risk.value);
+  risk = book.risk();
+  EXPECT_NEAR(rate_estimate, risk.value, 1e-5 * value);
+  const cqf::portfolio_risk<double> scratch = build().risk();
+  EXPECT_NEAR(risk.value, scratch.value, 1e-12 * risk.value);
+  EXPECT_NEAR(risk.rho, scratch.rho, 1e-12 * std::abs(risk.rho));
+  EXPECT_NEAR(risk.dv01, scratch.dv01, 1e-12 * risk.dv01);
+}
+TEST_F(TestSuite, aad) {
+  using var = cqf::var<double>;
+  cqf::tape<double> tape;
+
+  // every sensitivity of a vanilla from one reverse sweep
+  const var S = tape.variable(100.), K = tape.variable(95.), T = tape.variable(1.5);
+  const var r = tape.variable(0.03), q = tape.variable(0.01), sigma = tape.variable(0.25);
+  const var premium = cqf::call_vanilla<var>(S, K, T, r, q, sigma).premium();
+  tape.propagate(premium);
+  const cqf::call_vanilla<double> call(100., 95., 1.5, 0.03, 0.01, 0.25);
+  EXPECT_NEAR(premium.value(), call.premium(), 1e-13);
+  EXPECT_NEAR(tape.adjoint(S), call.delta(), 1e-13);
+  EXPECT_NEAR(tape.adjoint(sigma), call.vega(), 1e-12);
+  EXPECT_NEAR(tape.adjoint(r), call.rho(), 1e-12);
+  EXPECT_NEAR(tape.adjoint(T), -call.theta(), 1e-12);
+  EXPECT_NEAR(tape.adjoint(K), -std::exp(-0.03 * 1.5) * cqf::norm_cdf(call.d2()), 1e-13);
+  EXPECT_NEAR(tape.adjoint(q), -1.5 * call.SPV() * cqf::norm_cdf(call.d1()), 1e-12);
+
+  // a rewound tape records again from scratch
+  const size_t recorded = tape.size();
+  tape.rewind();
+  EXPECT_EQ(tape.size(), 1);
+  const var spot = tape.variable(100.);
+  const var put = cqf::put_vanilla<var>(spot, 95., 1.5, 0.03, 0.01, 0.25).premium();
+  tape.propagate(put);
+  EXPECT_LT(tape.size(), recorded);
+  EXPECT_NEAR(tape.adjoint(spot), cqf::put_vanilla<double>(100., 95., 1.5, 0.03, 0.01, 0.25).delta(), 1e-13);
+
+  // yield sensitivity of a bond, and sensitivities to the discount factors of the knots of a curve,
+  // none to the knots beyond its maturity
+  tape.rewind();
+  const var y = tape.variable(0.035);
+  const var B = cqf::coupon_bond<var>(10., 4., y).price();
+  tape.propagate(B);
+  EXPECT_NEAR(tape.adjoint(y), -1e4 * cqf::coupon_bond<double>(10., 4., 0.035).analytics().dv01, 1e-9);
+
+  tape.rewind();
+  const double knots[] = {1., 2., 5., 10., 30.};
+  double P[] = {0.98, 0.955, 0.87, 0.74, 0.38};
+  std::vector<var> times, discount;
+  for (size_t k = 0; k < 5; ++k) {
+    times.emplace_back(knots[k]);
+    discount.push_back(tape.variable(P[k]));
+  }
+  const cqf::yield_curve<var> curve(times.data(), discount.data(), 5);
+  const var price = cqf::coupon_bond<var>(9.3, 5., 0.).price(curve);
+  tape.propagate(price);
+  for (size_t k = 0; k < 5; ++k) {
+    const auto bumped = [&](double h) {
+      double shifted[5];
+      std::copy(P, P + 5, shifted);
+      shifted[k] += h;
+      return cqf::coupon_bond<double>(9.3, 5., 0.).price(cqf::yield_curve<double>(knots, shifted, 5));
+    };
+    EXPECT_NEAR(tape.adjoint(discount[k]), (bumped(1e-6) - bumped(-1e-6)) / 2e-6, 1e-5);
+  }
+  EXPECT_EQ(tape.adjoint(discount[4]), 0.);
+}
+TEST_F(TestSuite, dual) {
+  using dual = cqf::dual<double, 6>;
+  static_assert(std::is_same_v<cqf::promoted<dual>, dual>);
+  static_assert(std::is_same_v<cqf::promoted<int>, double>);
+
+  // the six first order sensitivities of a vanilla in one evaluation, at compile time
+  constexpr dual S = dual::variable(100., 0), K = dual::variable(95., 1), T = dual::variable(1.5, 2);
+  constexpr dual r = dual::variable(0.03, 3), q = dual::variable(0.01, 4), sigma = dual::variable(0.25, 5);
+  constexpr dual premium = cqf::call_vanilla<dual>(S, K, T, r, q, sigma).premium();
+  static_assert(premium.derivative(0) > 0. && premium.derivative(0) < 1.);
+  static_assert(premium.derivative(1) < 0.);
+
+  // and at runtime, against the closed forms
+  const dual runtime = cqf::call_vanilla<dual>(S, K, T, r, q, sigma).premium();
+  const cqf::call_vanilla<double> call(100., 95., 1.5, 0.03, 0.01, 0.25);
+  EXPECT_NEAR(runtime.value(), call.premium(), 1e-13);
+  EXPECT_NEAR(runtime.derivative(0), call.delta(), 1e-13);
+  EXPECT_NEAR(runtime.derivative(1), -std::exp(-0.03 * 1.5) * cqf::norm_cdf(call.d2()), 1e-13);
+  EXPECT_NEAR(runtime.derivative(2), -call.theta(), 1e-12);
+  EXPECT_NEAR(runtime.derivative(3), call.rho(), 1e-12);
+  EXPECT_NEAR(runtime.derivative(4), -1.5 * call.SPV() * cqf::norm_cdf(call.d1()), 1e-12);
+  EXPECT_NEAR(runtime.derivative(5), call.vega(), 1e-12);
+  for (size_t i = 0; i < 6; ++i) {
+    EXPECT_NEAR(premium.derivative(i), runtime.derivative(i), 1e-12 * (1. + std::abs(runtime.derivative(i))));
+  }
+
+  // second order by nesting: gamma of a put, and the yield sensitivity of a bond
+  using nested = cqf::dual<cqf::dual<double, 1>, 1>;
+  const nested spot = nested::variable(cqf::dual<double, 1>::variable(100., 0), 0);
+  const nested put = cqf::put_vanilla<nested>(spot, 95., 1.5, 0.03, 0.01, 0.25).premium();
+  const cqf::put_vanilla<double> reference(100., 95., 1.5, 0.03, 0.01, 0.25);
+  EXPECT_NEAR(put.derivative(0).value(), reference.delta(), 1e-13);
+  EXPECT_NEAR(put.derivative(0).derivative(0), reference.gamma(), 1e-13);
+  const auto B = cqf::coupon_bond<cqf::dual<double, 1>>(10., 4., cqf::dual<double, 1>::variable(0.035, 0)).price();
+  EXPECT_NEAR(B.derivative(0), -1e4 * cqf::coupon_bond<double>(10., 4., 0.035).analytics().dv01, 1e-9);
+
+  // trigonometric functions, at runtime as well
+  const cqf::dual<double, 1> angle = cqf::dual<double, 1>::variable(0.7, 0);
+  EXPECT_NEAR(cqf::sin(angle).derivative(0), std::cos(0.7), 1e-15);
+  EXPECT_NEAR(cqf::cos(angle).derivative(0), -std::sin(0.7), 1e-15);
+}
+TEST_F(TestSuite, high_precision) {
+  using word = cqf::double_word<double>;
+
+  // error-free transformations
+  constexpr word sum = word::two_sum(1., 1e-20);
+  static_assert(sum.hi == 1. && sum.lo == 1e-20);
+  constexpr double u = 1. / (1 << 30);
+  constexpr word product = word::two_product(1. + u, 1. - u);
+  static_assert(product.hi == 1. && product.lo == -u * u);
+
+  // series in double words, correctly rounded but for ties, where the plain ones lose up to a hundred ulps
+  for (double x = -700.; x < 700.; x += 0.731) {
+    const double reference = static_cast<double>(std::exp(static_cast<long double>(x)));
+    EXPECT_NEAR((cqf::impl::exp_impl<double, word>(x)), reference, reference * 1.2e-16);
+  }
+  for (double x = -4.; x <= 4.; x += 0.0173) {
+    const double reference = static_cast<double>(std::erfc(static_cast<long double>(x)));
+    EXPECT_NEAR((cqf::impl::erfc_impl<double, word>(x)), reference, reference * 1.2e-16);
+  }
+  static_assert(cqf::erf(1e-20) > 1.128e-20 && cqf::erf(1e-20) < 1.129e-20);
+
+  // double-word accumulation of the integral: 1 + 1000 * 1e-16 would round back to 1 term by term
+  const double area = cqf::impl::integrate_sum([](double) { return 1e-16; }, 1., 0., 1., 999.);
+  EXPECT_NEAR(area, 1. + 1e-13, 1e-16);
+
+#if CQF_HAS_FLOAT128
+  using quad = __float128;
+  static_assert(cqf::limits<quad>::digits == 113);
+  static_assert(cqf::limits<quad>::epsilon() * 0x1p112 == 1);
+  static_assert(std::is_same_v<cqf::promoted<quad>, quad>);
+
+  // against long double, as precise as the reference allows, and consistent to the last bits of quad
+  const auto close = [](quad a, long double b) { return std::abs(static_cast<long double>(a - b)) <= 1e-18l * std::abs(b); };
+  EXPECT_TRUE(close(cqf::exp(static_cast<quad>(1.5)), std::exp(1.5l)));
+  EXPECT_TRUE(close(cqf::ln(static_cast<quad>(7)), std::log(7.l)));
+  EXPECT_TRUE(close(cqf::sqrt(static_cast<quad>(2)), std::sqrt(2.l)));
+  EXPECT_TRUE(close(cqf::erfc(static_cast<quad>(3.9l)), std::erfc(3.9l)));
+  EXPECT_TRUE(close(cqf::constants<quad>::pi, 3.14159265358979323846264338327950288l));
+  EXPECT_LT(std::abs(static_cast<double>(cqf::exp(cqf::ln(static_cast<quad>(7))) - 7)), 1e-32);
+  EXPECT_LT(std::abs(static_cast<double>(cqf::sqrt(static_cast<quad>(2)) * cqf::sqrt(static_cast<quad>(2)) - 2)),
+            1e-33);
+
+  // the error function to quadruple precision, against references given as a long double and its remainder
+  const auto exact = [](quad a, long double high, long double low) {
+    const quad reference = cqf::impl::extended<quad>(high, low);
+    return std::abs(static_cast<double>((a - reference) / reference)) < 1e-31;
+  };
+  EXPECT_TRUE(exact(cqf::erf(static_cast<quad>(0.75)), 7.111556336535151316247e-01l, -2.575646081771731648967e-20l));
+  EXPECT_TRUE(exact(cqf::erfc(static_cast<quad>(5)), 1.537459794428034850193e-12l, -4.166391158554555219603e-33l));
+  EXPECT_TRUE(exact(cqf::erfc(static_cast<quad>(6)), 2.151973671249891311659e-17l, -1.745031421881330065279e-40l));
+  EXPECT_TRUE(exact(cqf::erfc(static_cast<quad>(8)), 1.122429717298292708014e-29l, -1.709753171061340883823e-49l));
+  EXPECT_TRUE(exact(cqf::norm_cdf(static_cast<quad>(-6)), 9.865876450376981407030e-10l, -2.105822614768687057963e-30l));
+
+  // trigonometric functions at runtime, by their Taylor series on the wrapped angle
+  EXPECT_TRUE(exact(cqf::sin(static_cast<quad>(1)), 8.414709848078965066646e-01l, -1.208849166554639635937e-20l));
+  EXPECT_TRUE(exact(cqf::cos(static_cast<quad>(1)), 5.403023058681397174140e-01l, -1.307075393053035252173e-20l));
+  EXPECT_TRUE(exact(cqf::sin(static_cast<quad>(3)), 1.411200080598672221022e-01l, -1.479902774052712320652e-21l));
+  EXPECT_TRUE(exact(cqf::cos(static_cast<quad>(10)), -8.390715290764524522606e-01l, 1.718361982415465455652e-21l));
+
+  // integrals: the Gauss-Kronrod rule in quad, and 1 + 1000 * 1e-35 accumulated without rounding back to 1
+  const quad e_minus_one = cqf::exp(static_cast<quad>(1)) - 1;
+  const quad kronrod = cqf::integrate<quad>([](quad x) { return cqf::exp(x); }, 0, 1);
+  EXPECT_LT(std::abs(static_cast<double>((kronrod - e_minus_one) / e_minus_one)), 1e-32);
+  const quad tiny = cqf::impl::integrate_sum([](quad) { return static_cast<quad>(1e-35l); },
+                                             static_cast<quad>(1), static_cast<quad>(0), static_cast<quad>(1),
+                                             static_cast<quad>(999));
+  EXPECT_LT(std::abs(static_cast<double>(tiny - 1) - 1e-32), 2e-34);
+
+  // reference premiums validating the double ones
+  const quad premium = cqf::call_vanilla<quad>(100, 95, 1.5, 0.03, 0.01, 0.25).premium();
+  EXPECT_TRUE(close(premium, cqf::call_vanilla<long double>(100, 95, 1.5, 0.03, 0.01, 0.25).premium()));
+  EXPECT_NEAR(static_cast<double>(premium), cqf::call_vanilla<double>(100., 95., 1.5, 0.03, 0.01, 0.25).premium(), 1e-13);
+  const quad far = cqf::call_vanilla<quad>(100, 400, 1, 0.03, 0.01, 0.2).premium();
+  const long double far_reference = cqf::call_vanilla<long double>(100, 400, 1, 0.03, 0.01, 0.2).premium();
+  EXPECT_LT(std::abs(static_cast<double>((far - far_reference) / far_reference)), 1e-15);
+#endif
+}
+#pragma clang diagnostic pop